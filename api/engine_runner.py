@@ -73,8 +73,8 @@ class EngineRunner:
         best_move = None
         eval_cp = None # default if none received 0.0 before.
 
-        # be generous: movetime + 5 seconds safety
-        deadline = time.time() + (movetime_ms / 1000.0) + 15.0  #Good safety buffer for deep searches.
+        # the engine answers within movetime; allow a little for process/pipe lag
+        deadline = time.time() + (movetime_ms / 1000.0) + 2.0
 
         while time.time() < deadline:
             try:
@@ -5,9 +5,10 @@ REM --------------------------------------------------
 
 echo Building Ashwathama Chess Engine...
 
-REM Compile with g++ (C++17, optimizations enabled)
+REM Compile with g++ (C++17, optimizations enabled, debug assertions off)
 REM Allow multiple definitions (workaround for header-only code)
-g++ -std=c++17 -O2 -Wl,--allow-multiple-definition -o engine.exe src/main.cpp src/uci.cpp -Isrc
+REM -pthread: perft splits its work across threads
+g++ -std=c++17 -O2 -DNDEBUG -pthread -Wl,--allow-multiple-definition -o engine.exe src/main.cpp src/uci.cpp -Isrc
 
 if %ERRORLEVEL% EQU 0 (
     echo.
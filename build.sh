@@ -5,9 +5,10 @@
 
 echo "Building Ashwathama Chess Engine..."
 
-# Compile with g++ (C++17, optimizations enabled)
+# Compile with g++ (C++17, optimizations enabled, debug assertions off)
 # Allow multiple definitions (workaround for header-only code)
-g++ -std=c++17 -O2 -Wl,--allow-multiple-definition -o engine src/main.cpp src/uci.cpp -Isrc
+# -pthread: perft splits its work across threads
+g++ -std=c++17 -O2 -DNDEBUG -pthread -Wl,--allow-multiple-definition -o engine src/main.cpp src/uci.cpp -Isrc
 
 if [ $? -eq 0 ]; then
     echo ""
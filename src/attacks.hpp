@@ -76,104 +76,234 @@ constexpr Bitboard king_attacks(Bitboard b) {
            move_south_west(b)  | move_south_east(b);
 }
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// Pawn captures only if an enemy piece is present (no en-passant).
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-inline Bitboard valid_pawn_captures(Bitboard singleBit, bool is_white, Bitboard opponentPieces)
-{
-    Bitboard diag = is_white
+// Pawn capture pattern for a single square (diagonals only, no en-passant)
+constexpr Bitboard pawn_attacks(Bitboard singleBit, bool is_white) {
+    return is_white
         ? (move_north_east(singleBit) | move_north_west(singleBit))
         : (move_south_east(singleBit) | move_south_west(singleBit));
-
-    // Keep only squares that contain opponent pieces
-    return diag & opponentPieces;
 }
 
-//Corected version
-/*
-inline Bitboard valid_pawn_captures(Bitboard singleBit, bool is_white, const std::array<PieceType, 64>& chessboard) {
-    Bitboard diag = is_white
-        ? (move_north_east(singleBit) | move_north_west(singleBit))
-        : (move_south_east(singleBit) | move_south_west(singleBit));
-
-    Bitboard captures = 0ULL;
-    while(diag) {
-        int targetSquare = __builtin_ctzll(diag);
-        diag &= diag - 1;  // Clear the lowest set bit from diag
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Precomputed leaper attack tables, one entry per square.
+// They are generated at compile time from the shift helpers above and live
+// in the binary, so a knight / king / pawn attack set is a single load.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-        PieceType targetPiece = chessboard[targetSquare];
-        if (is_white & isBlackPiece(targetPiece)) {
-            captures |= (1ULL << targetSquare);
-        } else if(!is_white & isWhitePiece(targetPiece)) {
-            captures |= (1ULL << targetSquare);
-        }
+template <typename AttackFn>
+constexpr std::array<Bitboard, 64> make_attack_table(AttackFn attacks) {
+    std::array<Bitboard, 64> table{};
+    for (int sq = 0; sq < 64; ++sq) {
+        table[sq] = attacks(1ULL << sq);
     }
-    return captures;
-}*/
+    return table;
+}
+
+inline constexpr std::array<Bitboard, 64> KnightAttacks = make_attack_table(knight_attacks);
+inline constexpr std::array<Bitboard, 64> KingAttacks   = make_attack_table(king_attacks);
+
+// Indexed by Color: PawnAttacks[White][sq] are the squares a white pawn on sq attacks
+inline constexpr std::array<Bitboard, 64> PawnAttacks[2] = {
+    make_attack_table([](Bitboard b) { return pawn_attacks(b, true); }),
+    make_attack_table([](Bitboard b) { return pawn_attacks(b, false); })
+};
 
 //inline Bitboard double_pawn_
 
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Sliding attacks (rook, bishop, queen directions).
-// We shift in a direction until hitting any piece or going off-board.
-// friendBlockers => squares occupied by your own pieces (minus the sliding piece).
-// opponentBlockers => squares occupied by the opponent.
+// Attacks are looked up in precomputed tables indexed by the occupancy of the
+// squares that can block the slider ("magic bitboards"). Each square owns a
+// slice of a shared table; the slice index is either a magic multiply-shift
+// or, when compiled for a CPU with BMI2 (-mbmi2 / -march=native), a PEXT.
+// The returned set includes the first blocker in every direction, whatever
+// its colour, so callers mask out their own pieces themselves.
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-Bitboard sliding_attacks(Bitboard singleBit,
-                         Bitboard friendBlockers,   // does not include this piece
-                         Bitboard opponentBlockers,
-                         direction dir)
-{
-    // Must have exactly one bit set
-    if (__builtin_popcountll(singleBit) != 1) {
-        std::cerr << "Error: Sliding_attacks can only take one bit set as input!\n";
-        exit(EXIT_FAILURE);
+
+#if defined(__BMI2__) && !defined(NO_PEXT)
+#include <immintrin.h>
+#define USE_PEXT
+#endif
+
+struct Magic {
+    Bitboard  mask;     // relevant blockers (board edges excluded)
+    Bitboard  magic;    // multiplier, unused on the PEXT path
+    Bitboard* attacks;  // this square's slice of the shared table
+    unsigned  shift;    // 64 - popcount(mask)
+
+    unsigned index(Bitboard occupied) const {
+#ifdef USE_PEXT
+        return unsigned(_pext_u64(occupied, mask));
+#else
+        return unsigned(((occupied & mask) * magic) >> shift);
+#endif
     }
+};
 
-    Bitboard attack_map = 0ULL;
-    Bitboard b = singleBit;
-
-    // Continue shifting in the given direction
-    while (true) {
-        // Move b one square in the chosen direction
-        switch(dir) {
-            case north:       b = move_north(b);       break;
-            case south:       b = move_south(b);       break;
-            case east:        b = move_east(b);        break;
-            case west:        b = move_west(b);        break;
-            case north_east:  b = move_north_east(b);  break;
-            case north_west:  b = move_north_west(b);  break;
-            case south_east:  b = move_south_east(b);  break;
-            case south_west:  b = move_south_west(b);  break;
-            default:
-                std::cerr << "Error: Invalid direction in sliding_attacks!\n";
-                exit(EXIT_FAILURE);
-        }
+inline Magic RookMagics[64];
+inline Magic BishopMagics[64];
+inline Bitboard RookTable[0x19000];   // 102400 entries for all 64 rook squares
+inline Bitboard BishopTable[0x1480];  //   5248 entries for all 64 bishop squares
 
-        // If we moved off-board (b == 0), stop
-        if (b == 0ULL) {
-            break;
-        }
+inline Bitboard rook_attacks(int square, Bitboard occupied) {
+    const Magic &m = RookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishop_attacks(int square, Bitboard occupied) {
+    const Magic &m = BishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queen_attacks(int square, Bitboard occupied) {
+    return rook_attacks(square, occupied) | bishop_attacks(square, occupied);
+}
 
-        // If there's a friendly piece, we can't capture or pass => stop
-        if (b & friendBlockers) {
-            break;
+// Squares a knight, bishop, rook, queen or king of either colour on `square`
+// attacks, sliders blocked by `occupied`. Pawns depend on the side and on
+// what stands in front of them, so the move generators deal with them.
+inline Bitboard piece_attacks(PieceType pt, int square, Bitboard occupied) {
+    switch (pt) {
+        case N: case n: return KnightAttacks[square];
+        case B: case b: return bishop_attacks(square, occupied);
+        case R: case r: return rook_attacks(square, occupied);
+        case Q: case q: return queen_attacks(square, occupied);
+        default:        return KingAttacks[square];
+    }
+}
+
+// Reference ray walk, only used to fill the tables at startup.
+inline Bitboard slow_sliding_attacks(int square, Bitboard occupied, const direction dirs[4]) {
+    Bitboard attack_map = 0ULL;
+    for (int d = 0; d < 4; ++d) {
+        Bitboard b = 1ULL << square;
+        while (true) {
+            switch (dirs[d]) {
+                case north:       b = move_north(b);       break;
+                case south:       b = move_south(b);       break;
+                case east:        b = move_east(b);        break;
+                case west:        b = move_west(b);        break;
+                case north_east:  b = move_north_east(b);  break;
+                case north_west:  b = move_north_west(b);  break;
+                case south_east:  b = move_south_east(b);  break;
+                case south_west:  b = move_south_west(b);  break;
+            }
+            if (b == 0ULL) break;          // walked off the board
+            attack_map |= b;
+            if (b & occupied) break;       // first blocker stops the ray
         }
+    }
+    return attack_map;
+}
 
-        // We can attack/occupy this square
-        attack_map |= b;
+// Magic multipliers, found offline by a seeded search for sparse random
+// numbers that map every blocker subset of a square without a destructive
+// collision.
+constexpr Bitboard RookMagicNumbers[64] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL,
+};
+
+constexpr Bitboard BishopMagicNumbers[64] = {
+    0x10102002004A1420ULL, 0x8020040400584008ULL, 0x10510800811201C8ULL, 0x5204042080000088ULL,
+    0x2204106880000002ULL, 0x1401042004000000ULL, 0x0400880410042004ULL, 0x0028208200A02020ULL,
+    0x1500241990010E00ULL, 0x8001200182020A40ULL, 0x40004101030B0000ULL, 0x8002041042000100ULL,
+    0x4010011041020038ULL, 0x0000010421044000ULL, 0x1500210808020A00ULL, 0x8000088400880520ULL,
+    0x0405004010040100ULL, 0x1005823210040108ULL, 0x2708008102040011ULL, 0x4048200404009100ULL,
+    0x0018104101400024ULL, 0x0003000601190101ULL, 0x8004803108491000ULL, 0x8014241200820800ULL,
+    0x0006E080100C3040ULL, 0x0501044A11041800ULL, 0x9020300008004045ULL, 0x0894080000220040ULL,
+    0x1001010083104000ULL, 0x5004030040900080ULL, 0x000400422C012400ULL, 0x0002128698404812ULL,
+    0x1010108404900440ULL, 0x0928021182084100ULL, 0x2006080409020024ULL, 0x1010202020180080ULL,
+    0xA010008200202200ULL, 0x2098015100019004ULL, 0x0002041440810811ULL, 0x802A02020000B098ULL,
+    0x0009015090004060ULL, 0x4000821082081001ULL, 0x0100210040420800ULL, 0x0800004010488A00ULL,
+    0x2000081104004040ULL, 0x4C8E029015000082ULL, 0x0420340322224842ULL, 0x1298260043400210ULL,
+    0x0000822802400008ULL, 0x00008A0101600000ULL, 0x3040003412080021ULL, 0x3040290220884800ULL,
+    0x4A1500401041004AULL, 0x8010200282020781ULL, 0x0020203142209091ULL, 0x0070300600902110ULL,
+    0x0040808800B62048ULL, 0x0000810400C44420ULL, 0x00080400440C0441ULL, 0x8340080020840411ULL,
+    0x0000000104208200ULL, 0x0000800810D00080ULL, 0x0400530411080200ULL, 0x4040702400932244ULL,
+};
+
+// Fill one piece type's magics and its slice of the shared table
+inline void init_magics(Magic magics[64], Bitboard table[],
+                        const Bitboard magic_numbers[64], const direction dirs[4]) {
+    const Bitboard edge_files = 0x0101010101010101ULL | 0x8080808080808080ULL;
+    const Bitboard edge_ranks = 0x00000000000000FFULL | 0xFF00000000000000ULL;
+
+    Bitboard *slice = table;
+    for (int sq = 0; sq < 64; ++sq) {
+        // Edge squares never block anything behind them, unless the slider
+        // itself sits on that edge line.
+        Bitboard edges = (edge_ranks & ~(0xFFULL << (8 * (sq / 8))))
+                       | (edge_files & ~(0x0101010101010101ULL << (sq % 8)));
+
+        Magic &m = magics[sq];
+        m.mask    = slow_sliding_attacks(sq, 0ULL, dirs) & ~edges;
+        m.magic   = magic_numbers[sq];
+        m.shift   = 64 - __builtin_popcountll(m.mask);
+        m.attacks = slice;
+
+        // Enumerate every subset of the mask (Carry-Rippler trick)
+        Bitboard subset = 0ULL;
+        do {
+            m.attacks[m.index(subset)] = slow_sliding_attacks(sq, subset, dirs);
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+
+        slice += 1ULL << __builtin_popcountll(m.mask);
+    }
+}
 
-        // If there's an opponent piece here, we can capture but then must stop
-        if (b & opponentBlockers) {
-            break;
+// Squares strictly between two squares on a common rank, file or diagonal,
+// and the whole line through them (both squares included); 0 if not aligned.
+// Used by legal move generation for check blocks and pin rays.
+inline Bitboard BetweenSquares[64][64];
+inline Bitboard LineThrough[64][64];
+
+inline void init_line_tables() {
+    for (int a = 0; a < 64; ++a) {
+        for (int c = 0; c < 64; ++c) {
+            Bitboard ends = (1ULL << a) | (1ULL << c);
+            BetweenSquares[a][c] = 0ULL;
+            LineThrough[a][c] = 0ULL;
+            if (a == c) continue;
+
+            if (rook_attacks(a, 0ULL) & (1ULL << c)) {
+                BetweenSquares[a][c] = rook_attacks(a, 1ULL << c) & rook_attacks(c, 1ULL << a);
+                LineThrough[a][c] = (rook_attacks(a, 0ULL) & rook_attacks(c, 0ULL)) | ends;
+            } else if (bishop_attacks(a, 0ULL) & (1ULL << c)) {
+                BetweenSquares[a][c] = bishop_attacks(a, 1ULL << c) & bishop_attacks(c, 1ULL << a);
+                LineThrough[a][c] = (bishop_attacks(a, 0ULL) & bishop_attacks(c, 0ULL)) | ends;
+            }
         }
     }
+}
 
-    return attack_map;
+inline bool init_sliding_attacks() {
+    const direction rook_dirs[4]   = {north, south, east, west};
+    const direction bishop_dirs[4] = {north_east, north_west, south_east, south_west};
+    init_magics(RookMagics, RookTable, RookMagicNumbers, rook_dirs);
+    init_magics(BishopMagics, BishopTable, BishopMagicNumbers, bishop_dirs);
+    init_line_tables();
+    return true;
 }
 
+// Built once at program start, before main() runs
+inline const bool sliding_attacks_ready = init_sliding_attacks();
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Debug function: prints a bitboard
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -188,138 +318,4 @@ void print_bitboard(Bitboard b) {
     std::cout << std::endl;
 }
 
-/**
- * calculate_attacks(...) populates `attack_map[i]` with all squares that the piece
- * on square i can attack. We only consider the side to move (is_white).
- *
- * For sliding pieces, we must remove the piece itself from friendBlockers so it
- * doesn't "block" its own sliding at square i.
- */
-
-inline Bitboard pawn_attacks(Bitboard singleBit, bool is_white) {
-    return is_white
-        ? (move_north_east(singleBit) | move_north_west(singleBit))
-        : (move_south_east(singleBit) | move_south_west(singleBit));
-}
-
-void calculate_attacks(const std::array<Bitboard, 12>& bitboards,
-                       const std::array<PieceType, 64>& chessboard,
-                       bool is_white,
-                       std::array<Bitboard, 64>& attack_map)
-{
-    // 1) Clear attack_map
-    attack_map.fill(0ULL);
-
-    // 2) friendBlockers / opponentBlockers for the current side
-    Bitboard friendPieces = is_white
-        ? (bitboards[P] | bitboards[R] | bitboards[N] | bitboards[B] | bitboards[Q] | bitboards[K])
-        : (bitboards[p] | bitboards[r] | bitboards[n] | bitboards[b] | bitboards[q] | bitboards[k]);
-
-    Bitboard opponentPieces = is_white
-        ? (bitboards[p] | bitboards[r] | bitboards[n] | bitboards[b] | bitboards[q] | bitboards[k])
-        : (bitboards[P] | bitboards[R] | bitboards[N] | bitboards[B] | bitboards[Q] | bitboards[K]);
-
-    // 3) For each square
-    for(int i = 0; i < 64; i++) {
-        PieceType piece = chessboard[i];
-        if (piece == e) continue; // empty
-        // Skip if piece color doesn't match
-        if (is_white && isBlackPiece(piece)) continue;
-        if (!is_white && isWhitePiece(piece)) continue;
-
-        // The single bit representing this piece
-        Bitboard singleBit = (1ULL << i);
-
-        // Remove *this piece* from friendBlockers so we don't block ourselves
-        Bitboard friendBlockers = friendPieces & ~singleBit;
-
-        // 4) Dispatch by piece type
-        if (piece == P) {
-            
-            Bitboard captures = valid_pawn_captures(singleBit, true, opponentPieces);
-            
-            Bitboard pseudo_map = (captures & ~(move_north(singleBit) & (friendBlockers) & (opponentPieces)));
-            attack_map[i] |= (pseudo_map & (move_north(singleBit) & (~friendBlockers) & (~opponentPieces)));
-            
-            
-            
-            
-            
-        }
-        else if (piece == N) {
-            attack_map[i] |= knight_attacks(singleBit);
-        }
-        else if (piece == B) {
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_west);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_west);
-        }
-        else if (piece == R) {
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, west);
-        }
-        else if (piece == Q) {
-            // Rook-like
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, west);
-            // Bishop-like
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_west);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_west);
-        }
-        else if (piece == K) {
-            attack_map[i] |= king_attacks(singleBit) & ~friendPieces;
-        }
-        else if (piece == p) {
-            //Black pawn diagonal captures 
-            Bitboard captures = valid_pawn_captures(singleBit, false, opponentPieces);
-            Bitboard pseudo_map = (captures & ~(move_south(singleBit) & (friendBlockers) & (opponentPieces)));
-            attack_map[i] |= (pseudo_map & (move_south(singleBit) & (~friendBlockers) & (~opponentPieces)));
-            
-            
-            
-        }
-        else if (piece == n) {
-            attack_map[i] |= knight_attacks(singleBit);
-        }
-        else if (piece == b) {
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_west);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_west);
-        }
-        else if (piece == r) {
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, west);
-        }
-        else if (piece == q) {
-            // Rook-like
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, west);
-            // Bishop-like
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, north_west);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_east);
-            attack_map[i] |= sliding_attacks(singleBit, friendBlockers, opponentPieces, south_west);
-        }
-        else if (piece == k) {
-            attack_map[i] |= king_attacks(singleBit) & ~friendPieces;;
-        }
-        // else 'e' was skipped, do nothing
-        //std::cout<<"h2 attack map:" << "\n";
-        //print_bitboard(attack_map[17]);
-    }
-
-}
-
 #endif // ATTACKS_HPP
\ No newline at end of file
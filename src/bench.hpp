@@ -0,0 +1,129 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.hpp"
+#include "evaluate.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Search benchmarks, run from the command line (see main.cpp).
+//
+// SMP scaling: search a few fixed positions to the same depth with 1, 2,
+// 4, ... threads and compare the time taken. Lazy SMP does not split the
+// tree, so the helpers pay off only through what they leave in the shared
+// table; time-to-depth is the honest measure of that, raw nps is not.
+// The table is cleared before every position so runs do not feed each other.
+//
+// Evaluation speed: the static evaluation of every position one and two
+// plies from the bench positions, over and over, in evaluations per second.
+// The pawn hash is bound as in search, so this measures the rest of the
+// leaf: it is the number to watch when changing evaluate_position().
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+inline const std::vector<std::string> &bench_positions() {
+    static const std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    };
+    return fens;
+}
+
+inline void run_smp_bench(int depth, int maxThreads, std::ostream &out = std::cout) {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+
+    out << "Time to depth " << depth << " over " << bench_positions().size() << " positions"
+        << " (" << std::thread::hardware_concurrency() << " hardware threads)\n\n"
+        << "Threads    Time(ms)       Nodes        NPS  Speedup\n";
+
+    long long baseMs = 0;
+    for (int threads : counts) {
+        long long ms = 0;
+        uint64_t nodes = 0;
+        for (const std::string &fen : bench_positions()) {
+            board chess_board;
+            UCI::parse_fen(chess_board, fen);
+            TT.clear();
+
+            Evaluator evaluator;
+            evaluator.max_depth = depth;
+            evaluator.threads = threads;
+
+            Clock::time_point start = Clock::now();
+            evaluator.get_best_move(chess_board);
+            ms += std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+            nodes += evaluator.nodes;
+        }
+        if (threads == 1) {
+            baseMs = ms;
+        }
+
+        out << std::setw(7) << threads
+            << std::setw(12) << ms
+            << std::setw(12) << nodes
+            << std::setw(11) << nodes * 1000 / uint64_t(std::max(1LL, ms))
+            << std::setw(9) << std::fixed << std::setprecision(2)
+            << double(baseMs) / double(std::max(1LL, ms)) << "\n";
+    }
+    out << std::endl;
+}
+
+inline void run_eval_bench(int rounds, std::ostream &out = std::cout) {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<board> positions;
+    for (const std::string &fen : bench_positions()) {
+        board root;
+        UCI::parse_fen(root, fen);
+        positions.push_back(root);
+        for (const Move &m1 : root.generateLegalMoves()) {
+            board child = root;
+            child.make_move(m1);
+            positions.push_back(child);
+            for (const Move &m2 : child.generateLegalMoves()) {
+                board grandchild = child;
+                grandchild.make_move(m2);
+                positions.push_back(grandchild);
+            }
+        }
+    }
+
+    PawnTables.ensure(1);
+    Evaluator evaluator;
+    evaluator.pawn_table = &PawnTables[0];
+
+    // The sum of all scores, so the work cannot be optimised away and so
+    // that changes which should not alter the evaluation can be checked
+    long long checksum = 0;
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const board &position : positions) {
+            checksum += evaluator.evaluate_position(position);
+        }
+    }
+    long long us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    uint64_t evals = uint64_t(positions.size()) * uint64_t(rounds);
+
+    out << "Evaluated " << positions.size() << " positions " << rounds << " times\n"
+        << "Evaluations : " << evals << "\n"
+        << "Time (ms)   : " << us / 1000 << "\n"
+        << "Evals/sec   : " << evals * 1000000 / uint64_t(std::max(1LL, us)) << "\n"
+        << "Score sum   : " << checksum << std::endl;
+}
+
+#endif // BENCH_HPP
@@ -11,6 +11,8 @@
 
 #include "file_interpreter.hpp"
 #include "utils.hpp"
+#include "zobrist.hpp"
+#include "psqt.hpp"
 
 struct board {
 
@@ -33,35 +35,30 @@ public:
     // 64-element array storing which piece is at each square
     std::array<PieceType, 64> chessboard; 
 
+    // Union of the bitboards above, kept in step by the piece helpers below
+    std::array<Bitboard, 2> colorOccupancy;   // indexed by Color (White, Black)
+    Bitboard occupancy;                       // both colours
+
     // Additional tracking info
     Color boardTurn;          // Whose move is it?
     int en_passant_square;    // -1 if none
-    // If you also need castling rights, you'd store them similarly
-
-    bool King_moved;      // used for castling rights
-    bool Rook_KingSide_moved;      // used for castling rights
-    bool Rook_QueenSide_moved;      // used for castling rights
-    bool Occupied_KingSide_Castling_Alley;     // used for castling rights
-    bool Occupied_QueenSide_Castling_Alley;     // used for castling rights
-
-    // -------------------------
-    // Castling helper masks / squares
-    // -------------------------
-
-    // Which squares originally held each rook
-    Bitboard WhiteRookKingSideSquare  = (1ULL << 7);   // h1
-    Bitboard WhiteRookQueenSideSquare = (1ULL << 0);   // a1
-    Bitboard BlackRookKingSideSquare  = (1ULL << 63);  // h8
-    Bitboard BlackRookQueenSideSquare = (1ULL << 56);  // a8
-
-    // Alleys the king must cross / must be empty to allow castling
-    // White: f1,g1 and b1,c1,d1
-    // Black: f8,g8 and b8,c8,d8
-    Bitboard WhiteRookKingSideAlley   = (1ULL << 5) | (1ULL << 6);        // f1,g1
-    Bitboard WhiteRookQueenSideAlley  = (1ULL << 1) | (1ULL << 2) | (1ULL << 3); // b1,c1,d1
-    Bitboard BlackRookKingSideAlley   = (1ULL << 61) | (1ULL << 62);      // f8,g8
-    Bitboard BlackRookQueenSideAlley  = (1ULL << 57) | (1ULL << 58) | (1ULL << 59); // b8,c8,d8
-    
+    int castling_rights;      // CastlingRight bits still available (KQkq)
+    Key key;                  // Zobrist key of the position, see compute_key()
+    Score psq;                // material + piece-square total, White's view, see compute_psq()
+    Key pawnKey;              // Zobrist key of the pawns alone, for the pawn hash
+
+    // What make_move() needs to restore a position in unmake_move().
+    // Everything else (which piece moved, where) is in the Move itself.
+    struct UndoInfo {
+        PieceType captured;       // piece taken by the move, e if none
+        int castling_rights;
+        int en_passant_square;
+        Key key;
+    };
+
+    // One record per move made since the last irreversible apply_move()
+    std::array<UndoInfo, MAX_PLY> undo_stack;
+    int undo_count;
 
     // -- Constructor --
     board() {
@@ -93,80 +90,104 @@ public:
         chessboard[56] = r; chessboard[57] = n; chessboard[58] = b; chessboard[59] = q;
         chessboard[60] = k; chessboard[61] = b; chessboard[62] = n; chessboard[63] = r;
 
+        refresh_occupancy();
+
         // en passant not available at the start
         en_passant_square = -1;
 
-        King_moved = false;
-        Rook_KingSide_moved = false;
-        Rook_QueenSide_moved = false;
-
-        Occupied_KingSide_Castling_Alley = false;
-        Occupied_QueenSide_Castling_Alley = false;
-
-
+        // Both sides may still castle on both wings
+        castling_rights = ALL_CASTLING;
+        undo_count = 0;
 
         // Decide whose turn it is based on number of moves read so far
         boardTurn = (num_of_moves % 2 == 0) ? White : Black;
-    }
 
-    Bitboard friendPieces() const {
-        return (boardTurn == White)
-        ? (bitboards[P] | bitboards[R] | bitboards[N] | bitboards[B] | bitboards[Q] | bitboards[K])
-        : (bitboards[p] | bitboards[r] | bitboards[n] | bitboards[b] | bitboards[q] | bitboards[k]);
-         ;
+        key = compute_key();
+        pawnKey = compute_pawn_key();
+        psq = compute_psq();
     }
 
-    Bitboard opponentPieces() const {
-        return (boardTurn == White)
-        ? (bitboards[p] | bitboards[r] | bitboards[n] | bitboards[b] | bitboards[q] | bitboards[k])
-        : (bitboards[P] | bitboards[R] | bitboards[N] | bitboards[B] | bitboards[Q] | bitboards[K]);
+    // Zobrist key built from scratch. make_move() keeps `key` up to date
+    // incrementally; this is for setting up a position and for checking.
+    Key compute_key() const {
+        Key hash = 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            if (chessboard[sq] != e) {
+                hash ^= Zobrist.pieceSquare[chessboard[sq]][sq];
+            }
+        }
+        hash ^= Zobrist.castling[castling_rights];
+        if (en_passant_square != -1) {
+            hash ^= Zobrist.enPassantFile[en_passant_square % 8];
+        }
+        if (boardTurn == Black) {
+            hash ^= Zobrist.blackToMove;
+        }
+        return hash;
     }
 
-
-    Bitboard getOccupied() const {
-        Bitboard occupied = 0;
-        for (const auto& bb : bitboards) {
-            occupied |= bb;
+    // Key of the pawn structure built from scratch; the piece helpers keep
+    // `pawnKey` up to date on their own
+    Key compute_pawn_key() const {
+        Key hash = 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            if (chessboard[sq] == P || chessboard[sq] == p) {
+                hash ^= Zobrist.pieceSquare[chessboard[sq]][sq];
+            }
         }
-        return occupied;
+        return hash;
     }
 
-    Bitboard getOccupiedByColor(bool isWhite) const {
-        Bitboard occupied = 0;
-        int start = isWhite ? 0 : 6;
-        for (int i = start; i < start + 6; ++i) {
-            occupied |= bitboards[i];
+    // Material and piece-square total built from scratch; the piece helpers
+    // keep `psq` up to date on their own
+    Score compute_psq() const {
+        Score total = 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            total += PSQT[chessboard[sq]][sq];
         }
-        return occupied;
+        return total;
     }
 
-    void Sides_Update(){
-    //King Side update
-    if ((boardTurn == White) && (getOccupied() && WhiteRookKingSideAlley)){
-            Occupied_KingSide_Castling_Alley = true;
-        } else if ((boardTurn == Black) && (getOccupied() && BlackRookKingSideAlley)) {
-            Occupied_KingSide_Castling_Alley = true;
+    // Rebuild the occupancy sets from the piece bitboards. Needed only after
+    // writing to `bitboards` directly (e.g. FEN parsing); the piece helpers
+    // keep them up to date on their own.
+    void refresh_occupancy() {
+        colorOccupancy.fill(0ULL);
+        for (int pt = P; pt <= K; ++pt) {
+            colorOccupancy[White] |= bitboards[pt];
+            colorOccupancy[Black] |= bitboards[pt + 6];
         }
+        occupancy = colorOccupancy[White] | colorOccupancy[Black];
+    }
 
-    //Queen Side update
-    if ((boardTurn == White) && (getOccupied() && WhiteRookQueenSideAlley)){
-            Occupied_QueenSide_Castling_Alley = true;
-        } else if ((boardTurn == Black) && (getOccupied() && BlackRookQueenSideAlley)) {
-            Occupied_QueenSide_Castling_Alley = true;
-        }
+    Bitboard friendPieces() const {
+        return colorOccupancy[boardTurn];
+    }
+
+    Bitboard opponentPieces() const {
+        return colorOccupancy[boardTurn == White ? Black : White];
+    }
+
+    Bitboard getOccupied() const {
+        return occupancy;
+    }
+
+    Bitboard getOccupiedByColor(bool isWhite) const {
+        return colorOccupancy[isWhite ? White : Black];
     }
 
      // initialising the functions to be defined in moves.hpp
+    Bitboard attackers_to(int square, Bitboard occupied) const;
+    bool is_square_attacked(int square, Color by) const;
+    bool is_square_attacked(int square, Color by, Bitboard occupied) const;
     bool isKingInCheck(Color turn) const;
-    std::vector<Move> generateLegalMoves() const;
-    std::vector<Move> generatePseudoLegalMoves() const;
+    Bitboard pinned_pieces(Color us, int kingSquare) const;
+    bool en_passant_exposes_king(int src, int kingSquare) const;
+    MoveList generateLegalMoves() const;
+    template <MoveType T> void generate(MoveList& moves) const;
+    bool is_pseudo_legal(const ::Move& m) const;
     Move generateRandomLegalMove() const;
 
-    void generateCastlingMoves(std::vector<Move>& moves) const;
-;
-    void generatePromotions(std::vector<Move>& moves) const;
-    void generatePawnMoves(std::vector<Move>& moves) const;
-
     
 
     // Helper to get char from a PieceType
@@ -200,12 +221,32 @@ public:
             return; // Nothing to remove
         }
 
-        // Clear it from that piece's bitboard
+        // Clear it from that piece's bitboard and the occupancy sets
         bitboards[pt] &= ~pos_bit;
+        colorOccupancy[pt < p ? White : Black] &= ~pos_bit;
+        occupancy &= ~pos_bit;
+        key ^= Zobrist.pieceSquare[pt][square];
+        psq -= PSQT[pt][square];
+        if (pt == P || pt == p) {
+            pawnKey ^= Zobrist.pieceSquare[pt][square];
+        }
         // Clear the array
         chessboard[square] = e;
     }
 
+    // Place a piece on an empty square
+    void put_piece_at(int square, PieceType pt) {
+        bitboards[pt] |= (1ULL << square);
+        colorOccupancy[pt < p ? White : Black] |= (1ULL << square);
+        occupancy |= (1ULL << square);
+        key ^= Zobrist.pieceSquare[pt][square];
+        psq += PSQT[pt][square];
+        if (pt == P || pt == p) {
+            pawnKey ^= Zobrist.pieceSquare[pt][square];
+        }
+        chessboard[square] = pt;
+    }
+
     // Move a piece from src to dst. This is a convenience function
     // that tries to move it in `bitboards` and `chessboard`.
     // Returns true if the piece was found at src and successfully moved
@@ -214,10 +255,16 @@ public:
         if (pt == e) {
             return false; // no piece
         }
-        // Remove from old location in its bitboard
-        bitboards[pt] &= ~(1ULL << srcSquare);
-        // Place in new location
-        bitboards[pt] |= (1ULL << dstSquare);
+        // Remove from old location in its bitboard, place in new location
+        Bitboard fromTo = (1ULL << srcSquare) | (1ULL << dstSquare);
+        bitboards[pt] ^= fromTo;
+        colorOccupancy[pt < p ? White : Black] ^= fromTo;
+        occupancy ^= fromTo;
+        key ^= Zobrist.pieceSquare[pt][srcSquare] ^ Zobrist.pieceSquare[pt][dstSquare];
+        psq += PSQT[pt][dstSquare] - PSQT[pt][srcSquare];
+        if (pt == P || pt == p) {
+            pawnKey ^= Zobrist.pieceSquare[pt][srcSquare] ^ Zobrist.pieceSquare[pt][dstSquare];
+        }
 
         // Update the chessboard array
         chessboard[dstSquare] = pt;
@@ -244,216 +291,183 @@ public:
 
 
 
-    // Apply a single move to the board, including castling, en passant, promotion
-    void apply_move(const ::Move &m) {
-        // Keep any derived occupancy / alley info updated if you rely on it.
-        // (We might revisit this if it causes side effects.)
-        Sides_Update();
-
-        // Convert one-hot bits to integer squares
-        int srcSquare = __builtin_ctzll(m.src_pos);
-        int dstSquare = __builtin_ctzll(m.dst_pos);
-
-        // Identify which piece is moving
-        PieceType movingPiece = chessboard[srcSquare];
-        if (movingPiece == e) {
-            std::cerr << "Warning: No piece at source square " << srcSquare << "\n";
-            return;
+    // Rook leg of a castling move, given the king's destination square
+    static void castling_rook_squares(int kingDst, int &rookSrc, int &rookDst) {
+        switch (kingDst) {
+            case 6:  rookSrc = 7;  rookDst = 5;  break;  // White O-O:   h1 -> f1
+            case 2:  rookSrc = 0;  rookDst = 3;  break;  // White O-O-O: a1 -> d1
+            case 62: rookSrc = 63; rookDst = 61; break;  // Black O-O:   h8 -> f8
+            default: rookSrc = 56; rookDst = 59; break;  // Black O-O-O: a8 -> d8
         }
+    }
 
-        bool isWhiteMoving = isWhitePiece(movingPiece);
-
-        // ============================
-        // CASTLING RIGHTS PRE-UPDATE
-        // ============================
+    // Make a move and push what is needed to take it back with unmake_move().
+    // The move must carry the right flags (as generated moves and
+    // uci_to_move() results do); apply_move() accepts looser input.
+    void make_move(const ::Move &m) {
+        UndoInfo &undo = undo_stack[undo_count++];
+        undo.castling_rights   = castling_rights;
+        undo.en_passant_square = en_passant_square;
+        undo.key               = key;
+
+        int srcSquare = m.src_square();
+        int dstSquare = m.dst_square();
+        PieceType movingPiece = chessboard[srcSquare];
+        bool isWhiteMoving = (boardTurn == White);
 
-        // If the king moved, that side cannot castle anymore
-        if (movingPiece == K && isWhiteMoving) {
-            King_moved = true;
-        } else if (movingPiece == k && !isWhiteMoving) {
-            King_moved = true;
+        // Take off whatever is captured, the pawn behind the target square for en passant
+        int captureSquare = dstSquare;
+        if (m.is_en_passant()) {
+            captureSquare = isWhiteMoving ? dstSquare - 8 : dstSquare + 8;
+        }
+        undo.captured = chessboard[captureSquare];
+        if (undo.captured != e) {
+            remove_piece_at(1ULL << captureSquare);
         }
 
-        // If a rook moved from its original squares, kill that rook's castling right.
-        // NOTE: we compare equality (==), not boolean &&
-        if (movingPiece == R && isWhiteMoving) {
-            if (m.src_pos == WhiteRookKingSideSquare) {
-                Rook_KingSide_moved = true;
-            }
-            if (m.src_pos == WhiteRookQueenSideSquare) {
-                Rook_QueenSide_moved = true;
-            }
-        } else if (movingPiece == r && !isWhiteMoving) {
-            if (m.src_pos == BlackRookKingSideSquare) {
-                Rook_KingSide_moved = true;
-            }
-            if (m.src_pos == BlackRookQueenSideSquare) {
-                Rook_QueenSide_moved = true;
+        move_piece_in_board(srcSquare, dstSquare);
+
+        if (m.is_castling()) {
+            int rookSrc, rookDst;
+            castling_rook_squares(dstSquare, rookSrc, rookDst);
+            move_piece_in_board(rookSrc, rookDst);
+        } else if (m.is_promotion()) {
+            PieceType newPT;
+            switch (m.flag()) {
+                case PROMOTION_QUEEN:  newPT = (isWhiteMoving ? Q : q); break;
+                case PROMOTION_ROOK:   newPT = (isWhiteMoving ? R : r); break;
+                case PROMOTION_BISHOP: newPT = (isWhiteMoving ? B : b); break;
+                default:               newPT = (isWhiteMoving ? N : n); break;
             }
+            remove_piece_at(1ULL << dstSquare);
+            put_piece_at(dstSquare, newPT);
         }
 
-        // ============================
-        // CASTLING MOVE EXECUTION
-        // ============================
-
-        bool isCastling = false;
-        // White king castles: e1 (4) -> g1 (6) or c1 (2)
-        if (movingPiece == K && srcSquare == 4 && (dstSquare == 6 || dstSquare == 2)) {
-            isCastling = true;
-            if (dstSquare == 6) {
-                // White O-O: rook h1(7) -> f1(5)
-                move_piece_in_board(7, 5);
-            } else {
-                // White O-O-O: rook a1(0) -> d1(3)
-                move_piece_in_board(0, 3);
-            }
+        // Moving the king or a rook, or capturing a rook at home, loses rights
+        key ^= Zobrist.castling[castling_rights];
+        castling_rights &= CastlingRightsMask[srcSquare] & CastlingRightsMask[dstSquare];
+        key ^= Zobrist.castling[castling_rights];
 
-            // Move the king itself
-            move_piece_in_board(srcSquare, dstSquare);
+        // A double pawn push leaves the square it jumped over as en passant target
+        if (en_passant_square != -1) {
+            key ^= Zobrist.enPassantFile[en_passant_square % 8];
+        }
+        en_passant_square = -1;
+        if ((movingPiece == P || movingPiece == p) && std::abs(dstSquare - srcSquare) == 16) {
+            en_passant_square = (srcSquare + dstSquare) / 2;
+            key ^= Zobrist.enPassantFile[en_passant_square % 8];
+        }
 
-            // After castling, white's castling rights are gone for sure
-            King_moved = true;
-            Rook_KingSide_moved = true;
-            Rook_QueenSide_moved = true;
+        boardTurn = isWhiteMoving ? Black : White;
+        key ^= Zobrist.blackToMove;
 
-            // No en passant target after castling
-            en_passant_square = -1;
+        assert(key == compute_key());
+        assert(psq == compute_psq());
+        assert(pawnKey == compute_pawn_key());
+    }
 
-            // Flip turn
-            boardTurn = (boardTurn == White) ? Black : White;
-            return;
+    // Take back the last move made with make_move()
+    void unmake_move(const ::Move &m) {
+        const UndoInfo &undo = undo_stack[--undo_count];
+
+        boardTurn = (boardTurn == White) ? Black : White;
+        bool isWhiteMoving = (boardTurn == White);
+
+        int srcSquare = m.src_square();
+        int dstSquare = m.dst_square();
+
+        if (m.is_promotion()) {
+            remove_piece_at(1ULL << dstSquare);
+            put_piece_at(dstSquare, isWhiteMoving ? P : p);
+        } else if (m.is_castling()) {
+            int rookSrc, rookDst;
+            castling_rook_squares(dstSquare, rookSrc, rookDst);
+            move_piece_in_board(rookDst, rookSrc);
         }
 
-        // Black king castles: e8 (60) -> g8 (62) or c8 (58)
-        if (movingPiece == k && srcSquare == 60 && (dstSquare == 62 || dstSquare == 58)) {
-            isCastling = true;
-            if (dstSquare == 62) {
-                // Black O-O: rook h8(63) -> f8(61)
-                move_piece_in_board(63, 61);
-            } else {
-                // Black O-O-O: rook a8(56) -> d8(59)
-                move_piece_in_board(56, 59);
+        move_piece_in_board(dstSquare, srcSquare);
+
+        if (undo.captured != e) {
+            int captureSquare = dstSquare;
+            if (m.is_en_passant()) {
+                captureSquare = isWhiteMoving ? dstSquare - 8 : dstSquare + 8;
             }
+            put_piece_at(captureSquare, undo.captured);
+        }
 
-            move_piece_in_board(srcSquare, dstSquare);
+        castling_rights   = undo.castling_rights;
+        en_passant_square = undo.en_passant_square;
+        key               = undo.key;   // the piece helpers above touched it too
 
-            King_moved = true;
-            Rook_KingSide_moved = true;
-            Rook_QueenSide_moved = true;
+        assert(key == compute_key());
+        assert(psq == compute_psq());
+        assert(pawnKey == compute_pawn_key());
+    }
 
+    // Pass the turn without moving, for null-move pruning. Not legal chess:
+    // only for the search, and never while the side to move is in check.
+    void make_null_move() {
+        UndoInfo &undo = undo_stack[undo_count++];
+        undo.captured          = e;
+        undo.castling_rights   = castling_rights;
+        undo.en_passant_square = en_passant_square;
+        undo.key               = key;
+
+        if (en_passant_square != -1) {
+            key ^= Zobrist.enPassantFile[en_passant_square % 8];
             en_passant_square = -1;
-            boardTurn = (boardTurn == White) ? Black : White;
-            return;
         }
+        boardTurn = (boardTurn == White) ? Black : White;
+        key ^= Zobrist.blackToMove;
 
-        // ============================
-        // EN PASSANT CAPTURE CHECK
-        // ============================
-
-        bool enPassantCapture = false;
-        if (movingPiece == P || movingPiece == p) {
-            int srcFile = srcSquare % 8;
-            int srcRank = srcSquare / 8;
-            int dstFile = dstSquare % 8;
-            int dstRank = dstSquare / 8;
-
-            if (en_passant_square != -1) {
-                if (dstSquare == en_passant_square &&
-                    (std::abs(dstFile - srcFile) == 1) &&
-                    (
-                        (isWhiteMoving && dstRank == srcRank + 1) ||
-                        (!isWhiteMoving && dstRank == srcRank - 1)
-                    )
-                ) {
-                    // This is en passant
-                    enPassantCapture = true;
-
-                    int capturedPawnSquare = isWhiteMoving
-                        ? (en_passant_square - 8)  // white takes black pawn behind
-                        : (en_passant_square + 8); // black takes white pawn behind
-
-                    remove_piece_at(1ULL << capturedPawnSquare);
-                }
-            }
-        }
+        assert(key == compute_key());
+    }
 
-        // ============================
-        // NORMAL CAPTURE (NOT EN PASSANT)
-        // ============================
-        if (!enPassantCapture) {
-            // If there's an enemy piece actually on dstSquare, remove it
-            remove_piece_at(m.dst_pos);
-        }
+    void unmake_null_move() {
+        const UndoInfo &undo = undo_stack[--undo_count];
+        boardTurn = (boardTurn == White) ? Black : White;
+        en_passant_square = undo.en_passant_square;
+        key               = undo.key;
+    }
 
-        // ============================
-        // PHYSICALLY MOVE PIECE src->dst
-        // ============================
-        bool movedOk = move_piece_in_board(srcSquare, dstSquare);
-        if (!movedOk) {
-            std::cerr << "Warning: move_piece_in_board failed from "
-                    << srcSquare << " to " << dstSquare << "\n";
-            en_passant_square = -1;
-            boardTurn = (boardTurn == White) ? Black : White;
+    // Does `side` have anything besides pawns and the king? Without it,
+    // zugzwang is common and passing is not a safe lower bound.
+    bool has_non_pawn_material(Color side) const {
+        int offset = (side == White) ? 0 : 6;
+        return (bitboards[N + offset] | bitboards[B + offset] |
+                bitboards[R + offset] | bitboards[Q + offset]) != 0;
+    }
+
+    // Apply a single move to the board for good, including castling, en passant, promotion.
+    // Used for game history (UCI "position ... moves", history files), where
+    // flags may be missing: castling and en passant are recognised from the board.
+    void apply_move(const ::Move &m) {
+        int srcSquare = m.src_square();
+        int dstSquare = m.dst_square();
+
+        // Identify which piece is moving
+        PieceType movingPiece = chessboard[srcSquare];
+        if (movingPiece == e) {
+            std::cerr << "Warning: No piece at source square " << srcSquare << "\n";
             return;
         }
 
-        // ============================
-        // PROMOTION
-        // ============================
-        if ((movingPiece == P || movingPiece == p) && (m.promotion != '\0')) {
-            int dstRank = dstSquare / 8;
-            bool whitePromote = (movingPiece == P && dstRank == 7);
-            bool blackPromote = (movingPiece == p && dstRank == 0);
-
-            if (whitePromote || blackPromote) {
-                PieceType newPT = e;
-                switch (m.promotion) {
-                    case 'q': newPT = (isWhiteMoving ? Q : q); break;
-                    case 'r': newPT = (isWhiteMoving ? R : r); break;
-                    case 'b': newPT = (isWhiteMoving ? B : b); break;
-                    case 'n': // 'n' for knight, also accept 'k' if you used that internally
-                    case 'k': newPT = (isWhiteMoving ? N : n); break;
-                    default:
-                        std::cerr << "Warning: Invalid promotion char " << m.promotion << "\n";
-                        break;
-                }
-
-                // clear pawn bit at dst
-                bitboards[movingPiece] &= ~(1ULL << dstSquare);
-                // set new piece bit
-                bitboards[newPT] |= (1ULL << dstSquare);
-                // fix mailbox
-                chessboard[dstSquare] = newPT;
-            }
+        MoveFlag flag = m.flag();
+        if ((movingPiece == K || movingPiece == k) && std::abs(dstSquare - srcSquare) == 2) {
+            flag = CASTLING;
+        } else if ((movingPiece == P || movingPiece == p) && dstSquare == en_passant_square) {
+            flag = EN_PASSANT;
+        } else if (flag == CASTLING || flag == EN_PASSANT) {
+            flag = NORMAL;
+        } else if (m.is_promotion() && !((movingPiece == P && dstSquare / 8 == 7) ||
+                                         (movingPiece == p && dstSquare / 8 == 0))) {
+            flag = NORMAL;  // only a pawn reaching the last rank promotes
         }
 
-        // ============================
-        // EN PASSANT TARGET SQUARE UPDATE
-        // ============================
-        // default: no en passant available
-        en_passant_square = -1;
-
-        // white pawn double push from rank 2 -> 4 (1 -> 3)
-        if (movingPiece == P) {
-            int srcRank = srcSquare / 8;
-            int dstRank = dstSquare / 8;
-            if (srcRank == 1 && dstRank == 3) {
-                en_passant_square = srcSquare + 8; // the square it "jumped over"
-            }
-        }
-        // black pawn double push from rank 7 -> 5 (6 -> 4)
-        else if (movingPiece == p) {
-            int srcRank = srcSquare / 8;
-            int dstRank = dstSquare / 8;
-            if (srcRank == 6 && dstRank == 4) {
-                en_passant_square = srcSquare - 8;
-            }
-        }
+        make_move(::Move(srcSquare, dstSquare, flag));
 
-        // ============================
-        // SWITCH SIDE TO MOVE
-        // ============================
-        boardTurn = (boardTurn == White) ? Black : White;
+        // The move is permanent, so its undo record is not kept
+        undo_count--;
     }
 
 
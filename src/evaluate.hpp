@@ -2,288 +2,205 @@
 
 #include <vector>
 #include <iostream>
+#include <sstream>
 #include <algorithm>
 #include <climits>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <thread>
 
 #include "board.hpp"
 #include "utils.hpp"
 #include "file_interpreter.hpp"
 #include "moves.hpp"
 #include "attacks.hpp"
+#include "tt.hpp"
+#include "movepick.hpp"
+#include "timeman.hpp"
+#include "pawns.hpp"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Lazy SMP: every search thread runs its own iterative deepening on the same
+// root, and they help each other only through the shared transposition
+// table. Helpers skip some depths so they do not all search the same tree in
+// step; each has its own move ordering state and node counter. The main thread owns the
+// clock and the output, and tells the helpers to stop when it is done.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// What the threads of one search share besides the table
+struct SharedSearch {
+    std::atomic<bool> stop{false};                     // the main thread has finished
+    std::unique_ptr<std::atomic<uint64_t>[]> nodes;    // per thread, published now and then
+    int threads;
+
+    explicit SharedSearch(int threadCount)
+        : nodes(new std::atomic<uint64_t>[threadCount]()), threads(threadCount) {}
+};
+
+// Margins for the forward pruning near the leaves, in centipawns per ply of
+// remaining depth; see alphabeta(). Settable as UCI options.
+struct PruningMargins {
+    int futility         = 100;
+    int reverse_futility = 90;
+    int razor            = 250;
+};
 
+// Late move reductions by depth and move number (both capped at 63): the
+// later a move comes in a deep node, the less likely it is to matter, and
+// the less depth it gets. Grows with the log of each.
+struct ReductionTable {
+    int table[64][64];
+
+    ReductionTable() {
+        for (int depth = 0; depth < 64; ++depth) {
+            for (int moveNumber = 0; moveNumber < 64; ++moveNumber) {
+                table[depth][moveNumber] = (depth == 0 || moveNumber == 0) ? 0
+                    : int(0.75 + std::log(double(depth)) * std::log(double(moveNumber)) / 2.25);
+            }
+        }
+    }
+
+    int operator()(int depth, int moveNumber) const {
+        return table[std::min(depth, 63)][std::min(moveNumber, 63)];
+    }
+};
+
+inline const ReductionTable Reductions;
+
+// Squares the king safety terms look at, per king square. The shield is
+// the king's file and its neighbours on the rank in front of the king
+// (above it for White, below it for Black); files stop at the edge of the
+// board instead of wrapping round to the other side.
+struct KingZoneTable {
+    Bitboard shield[2][64] = {};
+    Bitboard files[8] = {};       // the king's file and its neighbours
+
+    constexpr KingZoneTable() {
+        for (int sq = 0; sq < 64; ++sq) {
+            int file = sq % 8, rank = sq / 8;
+            for (int f = file - 1; f <= file + 1; ++f) {
+                if (f < 0 || f > 7) continue;
+                if (rank < 7) shield[White][sq] |= 1ULL << (sq + 8 + f - file);
+                if (rank > 0) shield[Black][sq] |= 1ULL << (sq - 8 + f - file);
+                if (rank == 0) files[file] |= FileMask[f];
+            }
+        }
+    }
+};
+
+inline constexpr KingZoneTable KingZones;
 
 /**
- * Example of explicit PST definitions for all pieces (White & Black).
- *
- * Note: These are sample values. You can tune them or replace them with
- * more sophisticated / official PSTs from open-source chess engines.
+ * Static evaluation and search. The material values and piece-square
+ * tables are in psqt.hpp; the board keeps their total as it changes.
  */
 struct Evaluator {
-    int max_depth = 1;
-
-    // Piece values for White & Black pieces. 
-    // Indexing:  0=P,1=R,2=N,3=B,4=Q,5=K, 6=p,7=r,8=n,9=b,10=q,11=k
-    int piece_values[12] = {
-        /* P */  100,
-        /* R */  500,
-        /* N */  320,
-        /* B */  330,
-        /* Q */  900,
-        /* K */  10000,
-
-        /* p */  100,
-        /* r */  500,
-        /* n */  320,
-        /* b */  330,
-        /* q */  900,
-        /* k */  10000
-    };
+    static constexpr int MAX_SEARCH_DEPTH = 64;
+    static constexpr uint64_t TIME_CHECK_NODES = 2048;   // poll the clock this often (power of two)
+    static constexpr int MAX_THREADS = 256;
+    static constexpr int ASPIRATION_DEPTH = 4;           // first depth searched with a window
+    static constexpr int FUTILITY_DEPTH = 3;             // futility and reverse futility up to here
+    static constexpr int RAZOR_DEPTH = 2;
+
+    int max_depth = 1;        // iterative deepening stops after this depth
+
+    // Time control for the current search, see get_best_move()
+    SearchLimits limits;
+    TimeManager time;
+    bool stopped = false;     // hard limit or stop_signal hit; the running iteration is thrown away
+    int completed_depth = 0;
+    bool print_info = false;  // send UCI "info" lines after each iteration
+    const std::atomic<bool> *stop_signal = nullptr;   // set by another thread to end the search
+
+    // Lazy SMP, see get_best_move(). Helpers are copies of the main
+    // Evaluator with their own thread_id.
+    int threads = 1;
+    int thread_id = 0;                    // 0 is the main thread
+    SharedSearch *shared = nullptr;       // only while a multi-threaded search runs
+
+    // This thread's killers, history and countermoves, from the Heuristics
+    // pool so they outlive the Evaluator; bound by iterative_deepening()
+    SearchHeuristics *heuristics = nullptr;
+
+    // This thread's pawn hash, bound the same way; without one (outside a
+    // search) the pawns are evaluated from scratch
+    PawnTable *pawn_table = nullptr;
+
+    // The move made at each ply on the way to the current node
+    Move move_stack[MAX_PLY];
+
+    // Nodes visited by this thread in the current search (alphabeta and quiescence)
+    uint64_t nodes = 0;
+
+    // Quiescence limits: a capture that cannot lift the score to within
+    // delta_margin of alpha is not searched, and each horizon node may spend
+    // at most qsearch_node_budget nodes before its captures are cut short.
+    int delta_margin = 200;
+    int qsearch_node_budget = 4096;
+    int qsearch_nodes_left = 0;
+
+    // Half-width of the first aspiration window around the last score
+    int aspiration_window = 30;
+
+    // Futility, reverse futility and razoring, see alphabeta()
+    PruningMargins margins;
+
+    // Null-move pruning from null_move_min_depth on, searching the null move
+    // null_move_reduction (+ depth / 6) plies shallower. Set while a null
+    // move cutoff in a pawn ending is being verified, where none are tried.
+    int null_move_min_depth = 3;
+    int null_move_reduction = 3;
+    bool verifying_null = false;
+
+    // Late move reductions: quiet moves from the lmr_min_moves-th on, in
+    // nodes at least lmr_min_depth deep
+    int lmr_min_depth = 3;
+    int lmr_min_moves = 3;
 
     // Slight bonus for having both bishops.
     const int bishop_pair_bonus = 30;
 
-    //==================================================
-    // 1) White Piece-Square Tables
-    //==================================================
-
-    // White Pawn PST
-    int white_pawn_pst[64] = {
-         0,  0,  0,  0,  0,  0,  0,  0,   // rank0 (a1..h1)
-         5, 10, 10,-20,-20, 10, 10,  5,   // rank1
-         5, -5, -5,  0,  0, -5, -5,  5,   // rank2
-         0,  0,  0, 20, 20,  0,  0,  0,   // rank3
-         5,  5, 10, 25, 25, 10,  5,  5,   // rank4
-        10, 10, 20, 30, 30, 20, 10, 10,   // rank5
-        50, 50, 50, 50, 50, 50, 50, 50,   // rank6
-         0,  0,  0,  0,  0,  0,  0,  0    // rank7
-    };
-
-    // White Knight PST
-    int white_knight_pst[64] = {
-        -50,-40,-30,-30,-30,-30,-40,-50,
-        -40,-20,  0,  0,  0,  0,-20,-40,
-        -30,  0, 10, 15, 15, 10,  0,-30,
-        -30,  5, 15, 20, 20, 15,  5,-30,
-        -30,  0, 15, 20, 20, 15,  0,-30,
-        -30,  5, 10, 15, 15, 10,  5,-30,
-        -40,-20,  0,  5,  5,  0,-20,-40,
-        -50,-40,-30,-30,-30,-30,-40,-50
-    };
-
-    // White Bishop PST
-    int white_bishop_pst[64] = {
-        -20,-10,-10,-10,-10,-10,-10,-20,
-        -10,  5,  0,  0,  0,  0,  5,-10,
-        -10, 10, 10, 10, 10, 10, 10,-10,
-        -10,  0, 10, 10, 10, 10,  0,-10,
-        -10,  5,  5, 10, 10,  5,  5,-10,
-        -10,  0,  5, 10, 10,  5,  0,-10,
-        -10,  0,  0,  0,  0,  0,  0,-10,
-        -20,-10,-10,-10,-10,-10,-10,-20
-    };
-
-    // White Rook PST
-    int white_rook_pst[64] = {
-          0,  0,  5, 10, 10,  5,  0,  0,
-         -5,  0,  0,  0,  0,  0,  0, -5,
-         -5,  0,  0,  0,  0,  0,  0, -5,
-         -5,  0,  0,  0,  0,  0,  0, -5,
-         -5,  0,  0,  0,  0,  0,  0, -5,
-         -5,  0,  0,  0,  0,  0,  0, -5,
-          5, 10, 10, 10, 10, 10, 10,  5,
-          0,  0,  5, 10, 10,  5,  0,  0
-    };
-
-    // White Queen PST
-    int white_queen_pst[64] = {
-        -20,-10,-10, -5, -5,-10,-10,-20,
-        -10,  0,  5,  0,  0,  0,  0,-10,
-        -10,  5,  5,  5,  5,  5,  0,-10,
-         -5,  0,  5,  5,  5,  5,  0, -5,
-          0,  0,  5,  5,  5,  5,  0, -5,
-        -10,  5,  5,  5,  5,  5,  0,-10,
-        -10,  0,  5,  0,  0,  0,  0,-10,
-        -20,-10,-10, -5, -5,-10,-10,-20
-    };
-
-    // White King PST (middle game, for example)
-    int white_king_pst[64] = {
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -20,-30,-30,-40,-40,-30,-30,-20,
-        -10,-20,-20,-20,-20,-20,-20,-10,
-         20, 20,  0,  0,  0,  0, 20, 20,
-         20, 30, 10,  0,  0, 10, 30, 20
-    };
-
-    //==================================================
-    // 2) Black Piece-Square Tables (mirrored versions)
-    //==================================================
-    // The logic here is to flip the White PST so rank0 in the white array
-    // becomes rank7 in the black array, rank1 -> rank6, etc.
-    // We do not multiply by -1 because the sign is already accounted for
-    // when we add/subtract in the evaluation routine.
-
-    // Black Pawn PST
-    int black_pawn_pst[64] = {
-         0,  0,  0,  0,  0,  0,  0,  0,   // rank0 for black = rank7 for white
-        50, 50, 50, 50, 50, 50, 50, 50,   // rank1 for black = rank6 for white
-        10, 10, 20, 30, 30, 20, 10, 10,   // rank2 for black = rank5
-         5,  5, 10, 25, 25, 10,  5,  5,   // rank3 for black = rank4
-         0,  0,  0, 20, 20,  0,  0,  0,   // rank4 for black = rank3
-         5, -5, -5,  0,  0, -5, -5,  5,   // rank5 for black = rank2
-         5, 10, 10,-20,-20, 10, 10,  5,   // rank6 for black = rank1
-         0,  0,  0,  0,  0,  0,  0,  0    // rank7 for black = rank0
-    };
-
-    // Black Knight PST
-    int black_knight_pst[64] = {
-        -50,-40,-30,-30,-30,-30,-40,-50,  // rank0 = white rank7
-        -40,-20,  0,  5,  5,  0,-20,-40,  // rank1 = white rank6
-        -30,  5, 10, 15, 15, 10,  5,-30,  // rank2 = white rank5
-        -30,  0, 15, 20, 20, 15,  0,-30,  // rank3 = white rank4
-        -30,  5, 15, 20, 20, 15,  5,-30,  // rank4 = white rank3
-        -30,  0, 10, 15, 15, 10,  0,-30,  // rank5 = white rank2
-        -40,-20,  0,  0,  0,  0,-20,-40,  // rank6 = white rank1
-        -50,-40,-30,-30,-30,-30,-40,-50   // rank7 = white rank0
-    };
-
-    // Black Bishop PST
-    int black_bishop_pst[64] = {
-        -20,-10,-10,-10,-10,-10,-10,-20,  // rank0
-        -10,  0,  0,  0,  0,  0,  0,-10,
-        -10,  0,  5, 10, 10,  5,  0,-10,
-        -10,  5,  5, 10, 10,  5,  5,-10,
-        -10,  0, 10, 10, 10, 10,  0,-10,
-        -10, 10, 10, 10, 10, 10, 10,-10,
-        -10,  5,  0,  0,  0,  0,  5,-10,
-        -20,-10,-10,-10,-10,-10,-10,-20   // rank7
-    };
-
-    // Black Rook PST
-    int black_rook_pst[64] = {
-          0,  0,  5, 10, 10,  5,  0,  0,  // rank0 = white rank7
-          5, 10, 10, 10, 10, 10, 10,  5,  // rank1 = white rank6
-         -5,  0,  0,  0,  0,  0,  0, -5,  // rank2 = white rank5
-         -5,  0,  0,  0,  0,  0,  0, -5,  // rank3 = white rank4
-         -5,  0,  0,  0,  0,  0,  0, -5,  // rank4 = white rank3
-         -5,  0,  0,  0,  0,  0,  0, -5,  // rank5 = white rank2
-         -5,  0,  0,  0,  0,  0,  0, -5,  // rank6 = white rank1
-          0,  0,  5, 10, 10,  5,  0,  0   // rank7 = white rank0
-    };
-
-    // Black Queen PST
-    int black_queen_pst[64] = {
-        -20,-10,-10, -5, -5,-10,-10,-20,  // rank0 = white rank7
-        -10,  0,  0,  0,  0,  0,  5,-10,
-        -10,  0,  5,  5,  5,  5,  5,-10,
-         -5,  0,  5,  5,  5,  5,  0, -5,
-          0,  0,  5,  5,  5,  5,  0, -5,
-        -10,  0,  5,  5,  5,  5,  5,-10,
-        -10,  0,  0,  0,  0,  0,  5,-10,
-        -20,-10,-10, -5, -5,-10,-10,-20   // rank7 = white rank0
-    };
-
-    // Black King PST (middle game, for example)
-    int black_king_pst[64] = {
-         20, 30, 10,  0,  0, 10, 30, 20,  // rank0 = white rank7
-         20, 20,  0,  0,  0,  0, 20, 20,
-        -10,-20,-20,-20,-20,-20,-20,-10,
-        -20,-30,-30,-40,-40,-30,-30,-20,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30   // rank7 = white rank0
-    };
-
-    //==================================================
-    // get_piece_square_bonus() with explicit black PST
-    //==================================================
-    int get_piece_square_bonus(PieceType pt, int sq) {
-        switch (pt) {
-            case P: return white_pawn_pst[sq];
-            case N: return white_knight_pst[sq];
-            case B: return white_bishop_pst[sq];
-            case R: return white_rook_pst[sq];
-            case Q: return white_queen_pst[sq];
-            case K: return white_king_pst[sq];
-
-            case p: return black_pawn_pst[sq];
-            case n: return black_knight_pst[sq];
-            case b: return black_bishop_pst[sq];
-            case r: return black_rook_pst[sq];
-            case q: return black_queen_pst[sq];
-            case k: return black_king_pst[sq];
-
-            default: return 0;
-        }
-    }
+    // Game phase for blending the midgame and endgame scores: minor piece 1,
+    // rook 2, queen 4; the start position has 24
+    static constexpr int TOTAL_PHASE = 24;
 
     //==================================================
     // 3) Evaluate position with heuristics
     //==================================================
     int evaluate_position(const board &chess_board) {
-        int score = 0;
-        int whiteBishops = 0;
-        int blackBishops = 0;
-
-        // Track pawns by file for rook open-file bonuses
-        int whitePawnFileCount[8] = {0};
-        int blackPawnFileCount[8] = {0};
-
-        std::vector<int> whiteRookSquares, blackRookSquares;
-
-        for (int sq = 0; sq < 64; sq++) {
-            PieceType pt = chess_board.chessboard[sq];
-            if (pt == e) continue;
-
-            // Material
-            int val = piece_values[pt];
-            // PST bonus
-            int pst_bonus = get_piece_square_bonus(pt, sq);
-
-            bool isWhite = isWhitePiece(pt);
-            int sign = (isWhite ? 1 : -1);
-
-            // Accumulate
-            score += sign * (val + pst_bonus);
-
-            // Count bishops for bishop pair
-            if (pt == B) whiteBishops++;
-            else if (pt == b) blackBishops++;
-
-            // Pawn file tracking
-            if (pt == P) {
-                whitePawnFileCount[sq % 8]++;
-            } else if (pt == p) {
-                blackPawnFileCount[sq % 8]++;
-            }
-
-            // Rook squares
-            if (pt == R) whiteRookSquares.push_back(sq);
-            if (pt == r) blackRookSquares.push_back(sq);
-        }
+        // Material and piece-square tables, kept up to date by the board.
+        // The halves are blended by how much non-pawn material is left.
+        int phase = std::min(TOTAL_PHASE,
+              __builtin_popcountll(chess_board.bitboards[N] | chess_board.bitboards[n] |
+                                   chess_board.bitboards[B] | chess_board.bitboards[b])
+            + 2 * __builtin_popcountll(chess_board.bitboards[R] | chess_board.bitboards[r])
+            + 4 * __builtin_popcountll(chess_board.bitboards[Q] | chess_board.bitboards[q]));
+        int score = (mg_value(chess_board.psq) * phase + eg_value(chess_board.psq) * (TOTAL_PHASE - phase))
+                  / TOTAL_PHASE;
+
+        // Pawn structure, and which files have pawns, from the pawn hash
+        PawnEntry scratch;
+        const PawnEntry &pawns = pawn_table ? pawn_table->probe(chess_board)
+                                            : (scratch = evaluate_pawns(chess_board));
+        int pawnScore = (mg_value(pawns.score) * phase + eg_value(pawns.score) * (TOTAL_PHASE - phase))
+                      / TOTAL_PHASE;
+        score += pawnScore;
+
+        int whiteBishops = __builtin_popcountll(chess_board.bitboards[B]);
+        int blackBishops = __builtin_popcountll(chess_board.bitboards[b]);
 
         // Bishop pair bonus
         if (whiteBishops >= 2) score += bishop_pair_bonus;
         if (blackBishops >= 2) score -= bishop_pair_bonus;
 
         // Rook open/semi-open file bonus
-        for (int sq : whiteRookSquares) {
-            int file = sq % 8;
-            int all_pawns_in_file = whitePawnFileCount[file] + blackPawnFileCount[file];
-            if (all_pawns_in_file == 0) score += 15;    // open
-            else if (whitePawnFileCount[file] == 0) score += 10;  // semi-open
-        }
-        for (int sq : blackRookSquares) {
-            int file = sq % 8;
-            int all_pawns_in_file = whitePawnFileCount[file] + blackPawnFileCount[file];
-            if (all_pawns_in_file == 0) score -= 15;    // open
-            else if (blackPawnFileCount[file] == 0) score -= 10;  // semi-open
-        }
-        score += evaluateKingSafety(chess_board);
+        Bitboard openFiles = pawns.open_files();
+        score += 15 * __builtin_popcountll(chess_board.bitboards[R] & openFiles)
+               + 10 * __builtin_popcountll(chess_board.bitboards[R] & pawns.semi_open_files(White) & ~openFiles);
+        score -= 15 * __builtin_popcountll(chess_board.bitboards[r] & openFiles)
+               + 10 * __builtin_popcountll(chess_board.bitboards[r] & pawns.semi_open_files(Black) & ~openFiles);
+        score += evaluateKingSafety(chess_board, pawns);
 
         return score;
     }
@@ -341,153 +258,548 @@ struct Evaluator {
             return best_eval;
         }
     }*/
-    int alphabeta(board &chess_board, int depth, int alpha, int beta, bool maximizing_player) {
-    if (depth == 0) {
-        return evaluate_position(chess_board);
-    }
+    //==================================================
+    // Quiescence search: at the horizon, keep resolving captures until the
+    // position is quiet, so the static evaluation is not taken in the middle
+    // of an exchange. Negamax like alphabeta: scores are for the side to move.
+    //==================================================
+    int quiescence(board &chess_board, int alpha, int beta, int ply) {
+        ++nodes;
+        --qsearch_nodes_left;
+        if (out_of_time()) {
+            return 0;
+        }
 
-    std::vector<Move> moves = chess_board.generateLegalMoves();
-    // or generatePseudoLegalMoves(), depending on your code,
-    // but typically you want actual legal moves.
-
-    // ============================
-    // Additional “pawn‐push pruning” step
-    // ============================
-    // Filter out any moves that are “pawn forward push” into an occupied square.
-    std::vector<Move> prunedMoves;
-    prunedMoves.reserve(moves.size());
-
-    for (auto &m : moves) {
-        // Identify if it’s a pawn
-        int srcIdx = __builtin_ctzll(m.src_pos);
-        PieceType pt = chess_board.chessboard[srcIdx];
-
-        bool isPawn = (pt == P || pt == p);
-        if (!isPawn) {
-            // Not a pawn → keep this move
-            prunedMoves.push_back(m);
-            continue;
+        if (ply >= MAX_PLY - 1) {
+            return evaluate_side_to_move(chess_board);
         }
 
-        // Check if the move is strictly forward (no file change).
-        int dstIdx = __builtin_ctzll(m.dst_pos);
-        int srcFile = srcIdx % 8;
-        int dstFile = dstIdx % 8;
-        int srcRank = srcIdx / 8;
-        int dstRank = dstIdx / 8;
+        // Captures that lose material by SEE are not even handed out here
+        MovePicker picker(chess_board);
 
-        bool sameFile = (srcFile == dstFile);
+        // Stand pat: the side to move can usually decline every capture, so the
+        // static score is a lower bound. Not when in check, where every reply is searched.
+        int stand_pat = 0;
+        if (!picker.inCheck) {
+            stand_pat = evaluate_side_to_move(chess_board);
+            if (qsearch_nodes_left <= 0 || stand_pat >= beta) {
+                return stand_pat;
+            }
+            alpha = std::max(alpha, stand_pat);
+        }
 
-        // White forward means dstRank > srcRank
-        // Black forward means dstRank < srcRank
-        bool isForwardPush = false;
-        if (pt == P) { 
-            isForwardPush = (sameFile && (dstRank == srcRank + 1 || dstRank == srcRank + 2));
-        } else {
-            // black pawn
-            isForwardPush = (sameFile && (dstRank == srcRank - 1 || dstRank == srcRank - 2));
+        int best_eval = picker.inCheck ? -(MATE_SCORE - ply) : stand_pat;
+
+        for (Move move = picker.next_move(); !move.is_null(); move = picker.next_move()) {
+            // Delta pruning: skip captures that cannot get back to the window
+            // even if the victim comes for free
+            if (!picker.inCheck && !move.is_promotion()) {
+                int gain = PieceValue[move.is_en_passant() ? P : chess_board.chessboard[move.dst_square()]];
+                if (stand_pat + gain + delta_margin <= alpha) {
+                    continue;
+                }
+            }
+
+            chess_board.make_move(move);
+            int eval = -quiescence(chess_board, -beta, -alpha, ply + 1);
+            chess_board.unmake_move(move);
+
+            if (eval > best_eval) {
+                best_eval = eval;
+                if (eval > alpha) {
+                    alpha = eval;
+                    if (alpha >= beta) {
+                        break;
+                    }
+                }
+            }
         }
 
-        if (isForwardPush) {
-            // If the destination is occupied by *any* piece, skip the move
-            PieceType occupant = chess_board.chessboard[dstIdx];
-            if (occupant != e) {
-                // Occupied, so skip this move = do not add to prunedMoves
-                continue;
+        // In check with no evasion is mate, and best_eval already says so
+        return best_eval;
+    }
+
+    // evaluate_position() is from White's point of view; the search wants
+    // the side to move's
+    int evaluate_side_to_move(const board &chess_board) {
+        int score = evaluate_position(chess_board);
+        return chess_board.boardTurn == White ? score : -score;
+    }
+
+    //==================================================
+    // Principal variation search (negamax): the score is for the side to
+    // move, and a child's score is the negation of its own.
+    // The first move of a node is searched with the full window. Every later
+    // move is expected to be worse and only has to prove that, with a null
+    // window (alpha, alpha + 1) which is much cheaper. If it unexpectedly
+    // beats alpha it is searched again with the full window. Nodes whose
+    // window is wider than null are PV nodes; the table may not cut them
+    // short, so the principal variation is always searched out.
+    //==================================================
+    int alphabeta(board &chess_board, int depth, int alpha, int beta, int ply) {
+    if (depth <= 0) {
+        qsearch_nodes_left = qsearch_node_budget;
+        return quiescence(chess_board, alpha, beta, ply);
+    }
+    ++nodes;
+    if (out_of_time()) {
+        return 0;
+    }
+
+    const bool pvNode  = beta - alpha > 1;
+    const int alphaOrig = alpha;
+
+    Move hashMove{};
+    TTEntry entry;
+    if (TT.probe(chess_board.key, entry)) {
+        hashMove = entry.move;
+        if (!pvNode && entry.depth >= depth) {
+            int ttScore = score_from_tt(entry.score, ply);
+            if (entry.bound == BOUND_EXACT ||
+                (entry.bound == BOUND_LOWER && ttScore >= beta) ||
+                (entry.bound == BOUND_UPPER && ttScore <= alpha)) {
+                return ttScore;
             }
         }
+    }
 
-        // Otherwise, it’s a capture or it’s a valid push → keep it
-        prunedMoves.push_back(m);
+    Color us = chess_board.boardTurn;
+    Move prevMove = ply > 0 ? move_stack[ply - 1] : Move();
+    const bool inCheck = chess_board.isKingInCheck(us);
+
+    // Forward pruning below trusts the static eval, so it is only done at
+    // non-PV nodes, out of check and away from mate scores
+    const bool canPrune = !pvNode && !inCheck && std::abs(alpha) < MATE_BOUND && std::abs(beta) < MATE_BOUND;
+    const int staticEval = canPrune ? evaluate_side_to_move(chess_board) : 0;
+
+    // Reverse futility: so far above beta that the opponent cannot win it
+    // back in the few plies left
+    if (canPrune && depth <= FUTILITY_DEPTH && staticEval - margins.reverse_futility * depth >= beta) {
+        return staticEval;
     }
-    // Now ‘prunedMoves’ has no forward‐push‐into‐occupied squares.
 
-    if (prunedMoves.empty()) {
-        // Then no moves left, checkmate or stalemate
-        return maximizing_player ? -9999999 : 9999999;
+    // Razoring: so far below alpha that only winning material could help.
+    // If the quiescence search finds nothing, neither will a full search.
+    if (canPrune && depth <= RAZOR_DEPTH && staticEval + margins.razor * depth <= alpha) {
+        qsearch_nodes_left = qsearch_node_budget;
+        int razorScore = quiescence(chess_board, alpha, alpha + 1, ply);
+        if (stopped) {
+            return 0;
+        }
+        if (razorScore <= alpha) {
+            return razorScore;
+        }
     }
 
-    // Proceed with alpha-beta
-    if (maximizing_player) {
-        int best_eval = std::numeric_limits<int>::min();
-        for (auto &move : prunedMoves) {
-            board old_board = chess_board;
-            chess_board.apply_move(move);
+    // Null-move pruning: let the opponent move twice in a row. If a reduced
+    // search still fails high we are so far ahead that a real move will too.
+    // Not in check, at PV nodes, twice in a row (prevMove is null after a
+    // null move) or near mate scores. With only pawns left zugzwang is
+    // likely, so there the cutoff must be confirmed by a normal reduced search.
+    if (canPrune && !verifying_null && depth >= null_move_min_depth &&
+        !prevMove.is_null() && staticEval >= beta) {
+        int R = null_move_reduction + depth / 6;
+
+        move_stack[ply] = Move();
+        chess_board.make_null_move();
+        int nullScore = -alphabeta(chess_board, depth - 1 - R, -beta, -beta + 1, ply + 1);
+        chess_board.unmake_null_move();
+
+        if (stopped) {
+            return 0;
+        }
+        if (nullScore >= beta) {
+            if (nullScore >= MATE_BOUND) {
+                nullScore = beta;   // an unproven mate, found by passing
+            }
+            if (chess_board.has_non_pawn_material(us)) {
+                return nullScore;
+            }
+            verifying_null = true;
+            int verified = alphabeta(chess_board, depth - 1 - R, beta - 1, beta, ply);
+            verifying_null = false;
+            if (verified >= beta) {
+                return nullScore;
+            }
+        }
+    }
+
+    // Moves come best-first and are only generated as far as needed
+    PieceType prevPiece = prevMove.is_null() ? e : chess_board.chessboard[prevMove.dst_square()];
+    MovePicker picker(chess_board, hashMove, heuristics->killers.moves[ply],
+                      heuristics->countermoves.get(prevPiece, prevMove), &heuristics->history);
+
+    // Quiet moves searched without a cutoff, to be marked down if a later one cuts
+    Move quietsTried[64];
+    int quietCount = 0;
+
+    int best_eval = -INFINITE_SCORE;
+    Move best_move{};
+    int movesSearched = 0;
+
+    for (Move move = picker.next_move(); !move.is_null(); move = picker.next_move()) {
+        bool quiet = is_quiet(chess_board, move);
+        bool badCapture = picker.is_bad_capture();
+
+        move_stack[ply] = move;
+        chess_board.make_move(move);
+        bool givesCheck = chess_board.isKingInCheck(chess_board.boardTurn);
+
+        // Futility pruning: near the leaves, a quiet move cannot lift a
+        // position this far below alpha. The first move is always searched,
+        // so the node never looks like it had no legal moves.
+        if (canPrune && depth <= FUTILITY_DEPTH && movesSearched > 0 && quiet && !givesCheck &&
+            staticEval + margins.futility * depth <= alpha) {
+            chess_board.unmake_move(move);
+            continue;
+        }
+        TT.prefetch(chess_board.key);
 
-            int eval = alphabeta(chess_board, depth - 1, alpha, beta, false);
-            chess_board = old_board;
+        int eval;
+        if (movesSearched == 0) {
+            eval = -alphabeta(chess_board, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            // Late move reductions: a quiet move this far down the list, or a
+            // capture that loses material by SEE, is first searched shallower,
+            // and again at full depth only if it beats alpha. Not in check,
+            // nor for moves that give check.
+            int reduction = 0;
+            if (depth >= lmr_min_depth && movesSearched + 1 >= lmr_min_moves && (quiet || badCapture) &&
+                !inCheck && !givesCheck) {
+                reduction = Reductions(depth, movesSearched) - (pvNode ? 1 : 0);
+                reduction = std::max(0, std::min(reduction, depth - 2));
+            }
 
-            best_eval = std::max(best_eval, eval);
-            alpha     = std::max(alpha, eval);
-            if (beta <= alpha) {
-                break; // alpha-beta cutoff
+            eval = -alphabeta(chess_board, depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+            if (reduction > 0 && eval > alpha) {
+                eval = -alphabeta(chess_board, depth - 1, -alpha - 1, -alpha, ply + 1);
+            }
+            if (eval > alpha && eval < beta) {
+                eval = -alphabeta(chess_board, depth - 1, -beta, -alpha, ply + 1);
             }
         }
-        return best_eval;
-    } else {
-        int best_eval = std::numeric_limits<int>::max();
-        for (auto &move : prunedMoves) {
-            board old_board = chess_board;
-            chess_board.apply_move(move);
-
-            int eval = alphabeta(chess_board, depth - 1, alpha, beta, true);
-            chess_board = old_board;
-
-            best_eval = std::min(best_eval, eval);
-            beta      = std::min(beta, eval);
-            if (beta <= alpha) {
-                break; // cutoff
+        chess_board.unmake_move(move);
+        ++movesSearched;
+
+        // An aborted subtree's score is meaningless; keep it out of the table
+        if (stopped) {
+            return 0;
+        }
+
+        if (eval > best_eval) {
+            best_eval = eval;
+            if (eval > alpha) {
+                alpha = eval;
+                best_move = move;
             }
         }
-        return best_eval;
+
+        if (alpha >= beta) {
+            // Remember quiet refutations for the sibling nodes and later
+            // searches, and mark down the quiet moves that failed before it
+            if (quiet) {
+                int bonus = HistoryTable::bonus(depth);
+                heuristics->killers.update(ply, move);
+                heuristics->history.update(us, move, bonus);
+                for (int i = 0; i < quietCount; ++i) {
+                    heuristics->history.update(us, quietsTried[i], -bonus);
+                }
+                heuristics->countermoves.update(prevPiece, prevMove, move);
+            }
+            break; // beta cutoff
+        }
+        if (quiet && quietCount < 64) {
+            quietsTried[quietCount++] = move;
+        }
     }
+
+    if (movesSearched == 0) {
+        // No moves left: checkmate if in check, otherwise stalemate (a draw)
+        return inCheck ? -(MATE_SCORE - ply) : 0;
+    }
+
+    Bound bound = (best_eval >= beta)     ? BOUND_LOWER
+                : (best_eval > alphaOrig) ? BOUND_EXACT
+                                          : BOUND_UPPER;
+    // After a fail low no move is known to be best (best_move is null), and
+    // the table keeps the old one
+    TT.store(chess_board.key, depth, score_to_tt(best_eval, ply), bound, best_move);
+    return best_eval;
 }
 
 
+    // Has the hard time limit passed, or were we told to stop? Polled every
+    // TIME_CHECK_NODES nodes, and never before the main thread has finished
+    // its first iteration so there is a move to play. Also publishes this
+    // thread's node count for the main thread's reports.
+    bool out_of_time() {
+        if (!stopped && (nodes & (TIME_CHECK_NODES - 1)) == 0) {
+            if (shared) {
+                shared->nodes[thread_id].store(nodes, std::memory_order_relaxed);
+            }
+            if ((completed_depth > 0 || thread_id != 0) && (time.hard_expired() || stop_requested())) {
+                stopped = true;
+            }
+        }
+        return stopped;
+    }
+
+    bool stop_requested() const {
+        return stop_signal && stop_signal->load(std::memory_order_relaxed);
+    }
+
+    //==================================================
+    // 5) Search the root moves to a fixed depth, within (alpha, beta).
+    //    PVS as in alphabeta. Returns the best score for the side to move;
+    //    at or outside the window it is only a bound, and the caller has to
+    //    search again with a wider one.
+    //==================================================
+    int search_root(board &chess_board, int depth, int alpha, int beta, Move &best_move) {
+        const int alphaOrig = alpha;
+        int bestEval = -INFINITE_SCORE;
+
+        // The previous iteration's best move is in the table and goes first
+        Move hashMove{};
+        TTEntry entry;
+        if (TT.probe(chess_board.key, entry)) {
+            hashMove = entry.move;
+        }
+        MovePicker picker(chess_board, hashMove, heuristics->killers.moves[0], Move(), &heuristics->history);
+
+        best_move = Move();   // stays null if there are no moves
+        int movesSearched = 0;
+        for (Move m = picker.next_move(); !m.is_null(); m = picker.next_move()) {
+            move_stack[0] = m;
+            chess_board.make_move(m);
+
+            int eval;
+            if (movesSearched == 0) {
+                eval = -alphabeta(chess_board, depth - 1, -beta, -alpha, 1);
+            } else {
+                eval = -alphabeta(chess_board, depth - 1, -alpha - 1, -alpha, 1);
+                if (eval > alpha && eval < beta) {
+                    eval = -alphabeta(chess_board, depth - 1, -beta, -alpha, 1);
+                }
+            }
+
+            chess_board.unmake_move(m);
+            ++movesSearched;
+            if (stopped) {
+                break;
+            }
+
+            if (eval > bestEval) {
+                bestEval = eval;
+                best_move = m;
+                if (eval > alpha) {
+                    alpha = eval;
+                    if (alpha >= beta) {
+                        break;
+                    }
+                }
+            }
+        }
+        if (!stopped && bestEval > alphaOrig && bestEval < beta) {
+            TT.store(chess_board.key, depth, score_to_tt(bestEval, 0), BOUND_EXACT, best_move);
+        }
+        return bestEval;
+    }
+
     //==================================================
-    // 5) Get the best move at the root
+    // 6) Get the best move: iterative deepening
+    //    Search depth 1, 2, 3, ... up to max_depth. Each iteration seeds the
+    //    move ordering of the next through the transposition table, and
+    //    from ASPIRATION_DEPTH on is searched with a narrow window around
+    //    the previous score, widened step by step if it fails. Stops
+    //    early when the soft time limit has passed after an iteration, or
+    //    when the hard limit interrupts one; the move from the last completed
+    //    iteration is played.
+    //    With threads > 1 the helpers start first and search until the main
+    //    thread is done. The deepest completed iteration of any thread gives
+    //    the move, the main thread's on a tie.
     //==================================================
     Move get_best_move(board &chess_board) {
-        bool maximizing = (chess_board.boardTurn == White);
-        std::vector<Move> moves = chess_board.generateLegalMoves();
+        TT.new_search();
+        Heuristics.ensure(threads);
+        PawnTables.ensure(threads);
+        if (threads <= 1) {
+            return iterative_deepening(chess_board);
+        }
 
-        if (moves.empty()) {
-            Move nullMove{};
-            return nullMove;  // no moves
+        SharedSearch sharedState(threads);
+        shared = &sharedState;
+
+        std::vector<Evaluator> helpers(threads - 1, *this);
+        std::vector<Move> helperMoves(threads - 1);
+        std::vector<std::thread> pool;
+        for (int i = 0; i < threads - 1; ++i) {
+            Evaluator &helper = helpers[i];
+            helper.thread_id   = i + 1;
+            helper.print_info  = false;
+            helper.limits      = SearchLimits();   // no clock: runs until told to stop
+            helper.stop_signal = &sharedState.stop;
+            pool.emplace_back([&helper, &move = helperMoves[i], position = chess_board]() mutable {
+                position.undo_count = 0;
+                move = helper.iterative_deepening(position);
+            });
         }
 
-        int alpha = std::numeric_limits<int>::min();
-        int beta  = std::numeric_limits<int>::max();
-        int bestEval = maximizing ? alpha : beta;
+        Move best_move = iterative_deepening(chess_board);
+
+        sharedState.stop = true;
+        for (std::thread &th : pool) {
+            th.join();
+        }
+
+        int bestDepth = completed_depth;
+        for (int i = 0; i < threads - 1; ++i) {
+            if (helpers[i].completed_depth > bestDepth && !helperMoves[i].is_null()) {
+                bestDepth = helpers[i].completed_depth;
+                best_move = helperMoves[i];
+            }
+            nodes += helpers[i].nodes;   // from here on, the whole search's count
+        }
+        shared = nullptr;
+        return best_move;
+    }
 
-        Move best_move = moves[0];
-        for (auto &m : moves) {
-            board oldBoard = chess_board;
-            chess_board.apply_move(m);
+    // Helpers leave out some depths, each in its own pattern, so that at any
+    // moment the threads are spread over two or three different depths
+    bool skip_depth(int depth) const {
+        static constexpr int SkipSize[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+        static constexpr int SkipPhase[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+        if (thread_id == 0) {
+            return false;
+        }
+        int i = (thread_id - 1) % 20;
+        return ((depth + SkipPhase[i]) / SkipSize[i]) % 2 != 0;
+    }
 
-            int eval = alphabeta(chess_board, max_depth - 1, alpha, beta, !maximizing);
+    // One thread's deepening loop; see get_best_move()
+    Move iterative_deepening(board &chess_board) {
+        heuristics = &Heuristics[thread_id];
+        pawn_table = &PawnTables[thread_id];
+        heuristics->new_search();
+        nodes = 0;
+        stopped = false;
+        completed_depth = 0;
+        time.init(limits, chess_board.boardTurn);
+
+        Move best_move{};
+        int score = 0;
+        for (int depth = 1; depth <= max_depth; ++depth) {
+            if (skip_depth(depth) && depth < max_depth) {
+                continue;
+            }
 
-            chess_board = oldBoard;
+            // Aspiration window; not around a mate score, which will not
+            // stay within a few centipawns
+            int delta = aspiration_window;
+            int alpha = -INFINITE_SCORE;
+            int beta  = INFINITE_SCORE;
+            if (depth >= ASPIRATION_DEPTH && completed_depth > 0 && std::abs(score) < MATE_BOUND) {
+                alpha = std::max(score - delta, -INFINITE_SCORE);
+                beta  = std::min(score + delta, INFINITE_SCORE);
+            }
 
-            if (maximizing) {
-                if (eval > bestEval) {
-                    bestEval = eval;
-                    best_move = m;
+            Move iterationBest;
+            while (true) {
+                score = search_root(chess_board, depth, alpha, beta, iterationBest);
+                if (stopped) {
+                    break;
                 }
-                if (eval > alpha) alpha = eval;
-                if (beta <= alpha) break;
-            } else {
-                if (eval < bestEval) {
-                    bestEval = eval;
-                    best_move = m;
+                if (score <= alpha && alpha > -INFINITE_SCORE) {
+                    alpha = std::max(score - delta, -INFINITE_SCORE);
+                } else if (score >= beta && beta < INFINITE_SCORE) {
+                    beta = std::min(score + delta, INFINITE_SCORE);
+                } else {
+                    break;
                 }
-                if (eval < beta) beta = eval;
-                if (beta <= alpha) break;
+                delta *= 2;
+            }
+            if (stopped || iterationBest.is_null()) {
+                break;
+            }
+            best_move = iterationBest;
+            completed_depth = depth;
+
+            if (print_info) {
+                report_iteration(chess_board, depth, score, best_move);
+            }
+
+            // A mate the search can already see will not get any better
+            if (std::abs(score) >= MATE_BOUND && MATE_SCORE - std::abs(score) <= depth) {
+                break;
+            }
+            if (time.soft_expired() || stop_requested()) {
+                break;
             }
         }
         return best_move;
     }
 
+    // Nodes searched so far by all threads; the helpers' counts lag a little
+    uint64_t total_nodes() const {
+        uint64_t sum = nodes;
+        if (shared) {
+            for (int i = 0; i < shared->threads; ++i) {
+                if (i != thread_id) {
+                    sum += shared->nodes[i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+        return sum;
+    }
+
+    // UCI "info" line for a finished iteration. The score is given from the
+    // side to move's point of view, the principal variation is read back
+    // from the transposition table.
+    void report_iteration(board &chess_board, int depth, int score, Move best_move) {
+        long long ms = time.elapsed();
+
+        // Built up first and written at once, so it cannot interleave with
+        // output from the UCI thread
+        std::ostringstream out;
+
+        out << "info depth " << depth << " score ";
+        if (std::abs(score) >= MATE_BOUND) {
+            int plies = MATE_SCORE - std::abs(score);
+            out << "mate " << (score > 0 ? (plies + 1) / 2 : -(plies / 2));
+        } else {
+            out << "cp " << score;
+        }
+        uint64_t allNodes = total_nodes();
+        out << " nodes " << allNodes
+            << " nps " << allNodes * 1000 / uint64_t(std::max(1LL, ms))
+            << " time " << ms
+            << " pv";
+
+        Move line[MAX_SEARCH_DEPTH];
+        int length = 0;
+        Move m = best_move;
+        while (length < depth && !m.is_null()) {
+            out << " " << moveToAlgebraic(m);
+            chess_board.make_move(m);
+            line[length++] = m;
+
+            // Follow the table, but only through moves legal here
+            TTEntry entry;
+            Move next{};
+            if (TT.probe(chess_board.key, entry)) {
+                MoveList legal = chess_board.generateLegalMoves();
+                for (const Move &candidate : legal) {
+                    if (candidate == entry.move) next = candidate;
+                }
+            }
+            m = next;
+        }
+        while (length > 0) {
+            chess_board.unmake_move(line[--length]);
+        }
+        out << "\n";
+        std::cout << out.str() << std::flush;
+    }
+
     //==================================================
     // Mock move generator
     //==================================================
@@ -496,12 +808,12 @@ struct Evaluator {
     // Optional: Quick test
     void test_evaluate(board &chess_board) {
     Move best = get_best_move(chess_board);
-    if (best.src_pos == 0ULL && best.dst_pos == 0ULL) {
+    if (best.is_null()) {
         std::cout << "No moves available.\n";
         return;
     }
-    int src = __builtin_ctzll(best.src_pos);
-    int dst = __builtin_ctzll(best.dst_pos);
+    int src = best.src_square();
+    int dst = best.dst_square();
     char src_file = 'a' + (src % 8);
     char src_rank = '1' + (src / 8);
     char dst_file = 'a' + (dst % 8);
@@ -510,8 +822,8 @@ struct Evaluator {
     std::cout << "Best move: "
               << src_file << src_rank 
               << dst_file << dst_rank;
-    if (best.promotion) {
-        std::cout << best.promotion;  // Append the promotion character directly
+    if (best.is_promotion()) {
+        std::cout << best.promotion();  // Append the promotion character directly
     }
     std::cout << "\n";
 }
@@ -521,13 +833,13 @@ struct Evaluator {
     //==================================================
     void test_random_move(board &chess_board) {
         Move random_move = get_random_move(chess_board);
-        if (random_move.src_pos == 0ULL && random_move.dst_pos == 0ULL) {
+        if (random_move.is_null()) {
             std::cout << "No legal moves available.\n";
             return;
         }
 
-        int src = __builtin_ctzll(random_move.src_pos);
-        int dst = __builtin_ctzll(random_move.dst_pos);
+        int src = random_move.src_square();
+        int dst = random_move.dst_square();
         char src_file = 'a' + (src % 8);
         char src_rank = '1' + (src / 8);
         char dst_file = 'a' + (dst % 8);
@@ -542,53 +854,30 @@ struct Evaluator {
     //======================
 // King Safety Function
 //======================
-int evaluateKingSafety(const board &chess_board) {
-    int safetyScore = 0;
-    const int directions[8] = {8, 9, 7, 1, -1, -7, -9, -8}; // N, NE, NW, E, W, SW, SE, S
-
-    bool whiteToMove = (chess_board.boardTurn == White);
-    Bitboard kingBB = whiteToMove ? chess_board.bitboards[K] : chess_board.bitboards[k];
-    if (kingBB == 0ULL) {
-        return whiteToMove ? -10000 : 10000;
-    }
-    int kingSquare = __builtin_ctzll(kingBB);
+// Both kings, from White's point of view
+int evaluateKingSafety(const board &chess_board, const PawnEntry &pawns) {
+    if (chess_board.bitboards[K] == 0ULL) return -10000;
+    if (chess_board.bitboards[k] == 0ULL) return 10000;
+    return kingSafety(chess_board, pawns, White) - kingSafety(chess_board, pawns, Black);
+}
 
-    std::vector<int> pawnShieldSquares;
-    if (whiteToMove) {
-        for (int d = 5; d <= 7; ++d) { 
-            int sq = kingSquare + directions[d];
-            if (sq >= 0 && sq < 64) pawnShieldSquares.push_back(sq);
-        }
-    } else {
-        for (int d = 0; d <= 2; ++d) {
-            int sq = kingSquare + directions[d];
-            if (sq >= 0 && sq < 64) pawnShieldSquares.push_back(sq);
-        }
-    }
+// One king, from its own side's point of view
+int kingSafety(const board &chess_board, const PawnEntry &pawns, Color side) {
+    int kingSquare = __builtin_ctzll(chess_board.bitboards[side == White ? K : k]);
 
-    for (int sq : pawnShieldSquares) {
-        PieceType piece = chess_board.chessboard[sq];
-        if ((whiteToMove && piece == P) || (!whiteToMove && piece == p)) {
-            safetyScore += 10;
-        } else {
-            safetyScore -= 5;
-        }
-    }
+    // Pawn shield: a bonus for each of our pawns on it, a penalty for each hole
+    Bitboard shield = KingZones.shield[side][kingSquare];
+    int shieldPawns = __builtin_popcountll(shield & chess_board.bitboards[side == White ? P : p]);
+    int safetyScore = 10 * shieldPawns - 5 * (__builtin_popcountll(shield) - shieldPawns);
 
-    for (int d = 0; d < 8; ++d) {
-        int adjacentSq = kingSquare + directions[d];
-        if (adjacentSq < 0 || adjacentSq >= 64) continue;
-        int kingFile = kingSquare % 8;
-        int adjFile = adjacentSq % 8;
-        if (abs(kingFile - adjFile) > 1) continue;
+    // Files at and next to the king with no pawn of ours to hide behind
+    // (counted on the first rank, one square per file)
+    Bitboard bareFiles = KingZones.files[kingSquare % 8] & pawns.semi_open_files(side);
+    safetyScore -= 10 * __builtin_popcountll(bareFiles & 0xFFULL);
 
-        PieceType adjacentPiece = chess_board.chessboard[adjacentSq];
-        if (adjacentPiece != e && 
-            ((whiteToMove && isBlackPiece(adjacentPiece)) || 
-             (!whiteToMove && isWhitePiece(adjacentPiece)))) {
-            safetyScore -= 20;
-        }
-    }
+    // Enemy pieces standing next to the king
+    Bitboard enemyPieces = chess_board.getOccupiedByColor(side == Black);
+    safetyScore -= 20 * __builtin_popcountll(KingAttacks[kingSquare] & enemyPieces);
 
     return safetyScore;
 }
@@ -61,23 +61,18 @@ std::vector<Move> read_inputfile(const char* inputfile) {
             int squareSrc = src_rank_index * 8 + src_file_index;
             int squareDst = dst_rank_index * 8 + dst_file_index;
 
-            // One-hot bit
-            Bitboard src_pos = (1ULL << squareSrc);
-            Bitboard dst_pos = (1ULL << squareDst);
-
-            // Create a Move object from utils.hpp
-            Move move;
-            move.src_pos = src_pos;
-            move.dst_pos = dst_pos;
-            move.promotion = promotion;
-
             // Detect if the move is a castling move
             // Castling moves are king moves from e1 to g1/c1 or e8 to g8/c8
+            MoveFlag flag = promotion_flag(promotion);
             if ((squareSrc == 4 && (squareDst == 6 || squareDst == 2)) ||
                 (squareSrc == 60 && (squareDst == 62 || squareDst == 58))) {
-                move.is_castling = true;
+                flag = CASTLING;
             }
 
+            // Pack it into a Move from utils.hpp; en passant is recognised
+            // by the board when the move is applied
+            Move move(squareSrc, squareDst, flag);
+
             // Add the move to the list
             moves.push_back(move);
             num_of_moves++;
@@ -4,6 +4,8 @@
 #include "file_interpreter.hpp"
 #include "utils.hpp"
 #include "uci.hpp"
+#include "perft.hpp"
+#include "bench.hpp"
 #include <sys/stat.h> // For checking file existence
 
 // Function to check if a file exists
@@ -30,6 +32,56 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    // Perft mode, for checking and timing the move generator
+    // Usage: ./Ashwathama --perft <depth> [--divide] [--threads <n>] [--hash <mb>] [--fen "<fen>"]
+    if (argc > 2 && std::strcmp(argv[1], "--perft") == 0) {
+        int depth = std::atoi(argv[2]);
+        bool divide = false;
+        int threads = default_perft_threads();
+        size_t hashMB = 0;
+        std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+        for (int i = 3; i < argc; i++) {
+            if (std::strcmp(argv[i], "--divide") == 0) {
+                divide = true;
+            } else if (std::strcmp(argv[i], "--threads") == 0 && (i + 1 < argc)) {
+                threads = std::atoi(argv[++i]);
+            } else if (std::strcmp(argv[i], "--hash") == 0 && (i + 1 < argc)) {
+                hashMB = std::strtoull(argv[++i], nullptr, 10);
+            } else if (std::strcmp(argv[i], "--fen") == 0 && (i + 1 < argc)) {
+                fen = argv[++i];
+            }
+        }
+
+        board chess_board;
+        UCI::parse_fen(chess_board, fen);
+        run_perft(chess_board, depth, divide, threads, hashMB);
+        return 0;
+    }
+
+    // SMP benchmark: time to a fixed depth with 1, 2, 4, ... search threads
+    // Usage: ./Ashwathama --smp-bench <depth> [--threads <max>]
+    if (argc > 2 && std::strcmp(argv[1], "--smp-bench") == 0) {
+        int depth = std::atoi(argv[2]);
+        int threads = default_perft_threads();
+        for (int i = 3; i < argc; i++) {
+            if (std::strcmp(argv[i], "--threads") == 0 && (i + 1 < argc)) {
+                threads = std::atoi(argv[++i]);
+            }
+        }
+        threads = std::max(1, std::min(threads, Evaluator::MAX_THREADS));
+        run_smp_bench(depth, threads);
+        return 0;
+    }
+
+    // Evaluation benchmark: static evaluations per second
+    // Usage: ./Ashwathama --eval-bench [rounds]
+    if (argc > 1 && std::strcmp(argv[1], "--eval-bench") == 0) {
+        int rounds = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 1000;
+        run_eval_bench(rounds);
+        return 0;
+    }
+
     //if (argc != 3){
     //    std::cerr << "Error: More than 3 arguments given!" << std::endl;
     //    return 1;
@@ -0,0 +1,367 @@
+#ifndef MOVEPICK_HPP
+#define MOVEPICK_HPP
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "board.hpp"
+#include "moves.hpp"
+#include "attacks.hpp"
+#include "see.hpp"
+#include "utils.hpp"
+
+// Rough piece worth for ordering only, indexed by PieceType (e counts as 0)
+inline constexpr int OrderValue[13] = {
+    /* P R N B Q K */ 1, 4, 2, 3, 5, 6,
+    /* p r n b q k */ 1, 4, 2, 3, 5, 6,
+    /* e */           0
+};
+
+// MVV-LVA: the most valuable victim first, and among equal victims the
+// least valuable attacker. A promotion counts the new piece as a victim.
+inline int mvv_lva(const board &chess_board, const Move &m) {
+    PieceType victim = m.is_en_passant() ? P : chess_board.chessboard[m.dst_square()];
+    int score = 8 * OrderValue[victim] - OrderValue[chess_board.chessboard[m.src_square()]];
+    if (m.is_promotion()) {
+        score += 8 * (m.flag() - PROMOTION_KNIGHT + 2);   // N=2, B=3, R=4, Q=5
+    }
+    return score;
+}
+
+// Captures and promotions change material; everything else is quiet
+inline bool is_quiet(const board &chess_board, const Move &m) {
+    return chess_board.chessboard[m.dst_square()] == e && !m.is_en_passant() && !m.is_promotion();
+}
+
+// Two quiet moves per ply that recently caused a beta cutoff. Sibling nodes
+// tend to be refuted by the same move, so they are tried right after captures.
+struct KillerTable {
+    Move moves[MAX_PLY][2];
+
+    void clear() {
+        for (auto &slot : moves) {
+            slot[0] = slot[1] = Move();
+        }
+    }
+
+    void update(int ply, const Move &m) {
+        if (moves[ply][0] != m) {
+            moves[ply][1] = moves[ply][0];
+            moves[ply][0] = m;
+        }
+    }
+};
+
+// Butterfly history: how often a quiet move (side, from, to) caused a beta
+// cutoff, weighted by depth, against how often it was searched in vain
+// before another move cut off. Updates pull the entry towards +-MAX so it
+// saturates instead of overflowing, and recent results count the most.
+struct HistoryTable {
+    static constexpr int MAX = 16384;
+
+    int table[2][64][64];
+
+    void clear() {
+        for (auto &side : table)
+            for (auto &from : side)
+                for (int &entry : from) entry = 0;
+    }
+
+    // Between searches: keep what was learned, but let the next search
+    // outvote it quickly
+    void age() {
+        for (auto &side : table)
+            for (auto &from : side)
+                for (int &entry : from) entry /= 2;
+    }
+
+    int get(Color us, const Move &m) const {
+        return table[us][m.src_square()][m.dst_square()];
+    }
+
+    // bonus > 0 for the move that cut off, < 0 for the ones that did not
+    void update(Color us, const Move &m, int bonus) {
+        bonus = std::max(-MAX, std::min(bonus, MAX));
+        int &entry = table[us][m.src_square()][m.dst_square()];
+        entry += bonus - entry * std::abs(bonus) / MAX;
+    }
+
+    static int bonus(int depth) {
+        return std::min(depth * depth * 16, MAX / 4);
+    }
+};
+
+// The quiet move that last refuted a given move, found by the piece that
+// moved and where it went. Many moves have one natural answer wherever they
+// are played (a check, a threat to a piece) that killers by ply miss.
+struct CounterMoveTable {
+    Move moves[12][64];
+
+    void clear() {
+        for (auto &piece : moves)
+            for (Move &m : piece) m = Move();
+    }
+
+    // `moved` is the piece now standing on prev.dst_square()
+    Move get(PieceType moved, const Move &prev) const {
+        return moved < e ? moves[moved][prev.dst_square()] : Move();
+    }
+
+    void update(PieceType moved, const Move &prev, const Move &reply) {
+        if (moved < e) {
+            moves[moved][prev.dst_square()] = reply;
+        }
+    }
+};
+
+// Everything the move ordering learns while searching. One per search
+// thread, and kept from one search to the next: killers are reset, the
+// history is aged. Cleared on "ucinewgame".
+struct SearchHeuristics {
+    KillerTable killers;
+    HistoryTable history;
+    CounterMoveTable countermoves;
+
+    SearchHeuristics() { clear(); }
+
+    void clear() {
+        killers.clear();
+        history.clear();
+        countermoves.clear();
+    }
+
+    void new_search() {
+        killers.clear();
+        history.age();
+    }
+};
+
+// The SearchHeuristics of each search thread, by thread id
+inline PerThread<SearchHeuristics> Heuristics;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Hands out a node's moves best-first, generating them in stages:
+//   1. the transposition table move, before anything is generated
+//   2. captures and promotions that do not lose material by SEE, best
+//      MVV-LVA first; the losing ones are put aside
+//   3. the two killer moves, then the countermove to the previous move
+//   4. the quiet moves, generated only if we get this far, best history first
+//   5. the losing captures put aside in stage 2
+// In check, the table move is followed by the evasions instead, captures first.
+// The quiescence search uses a second constructor that stops after stage 2,
+// dropping the losing captures (or gives the evasions), and has no table,
+// killer or history information.
+// Each stage picks its next move with one pass of selection sort rather
+// than sorting the whole list, since a cutoff usually comes early.
+// next_move() returns a null Move when there is nothing left.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct MovePicker {
+    enum Stage {
+        HASH_MOVE,
+        INIT_CAPTURES, CAPTURE_MOVES, KILLER_1, KILLER_2, COUNTER_MOVE, INIT_QUIETS, QUIET_MOVES,
+        BAD_CAPTURES,
+        INIT_EVASIONS, EVASION_MOVES,
+        DONE
+    };
+
+    board &chess_board;
+    Move ttMove;
+    Move killers[2];
+    Move counterMove;
+    const HistoryTable *history = nullptr;
+    bool inCheck;
+    bool capturesOnly = false;
+    int stage = HASH_MOVE;
+
+    MoveList moves;
+    int scores[MAX_MOVES];
+    int cursor = 0;
+
+    MoveList badCaptures;     // SEE < 0, in the order they came up
+    int badCursor = 0;
+
+    MovePicker(board &cb, Move hashMove, const Move killerMoves[2],
+               Move counter = Move(), const HistoryTable *historyTable = nullptr)
+        : chess_board(cb), ttMove(hashMove), counterMove(counter), history(historyTable),
+          inCheck(cb.isKingInCheck(cb.boardTurn)) {
+        killers[0] = killerMoves[0];
+        killers[1] = killerMoves[1];
+    }
+
+    // Quiescence search: captures and promotions only, or evasions in check
+    explicit MovePicker(board &cb)
+        : chess_board(cb), ttMove(), counterMove(), inCheck(cb.isKingInCheck(cb.boardTurn)), capturesOnly(true) {
+        killers[0] = killers[1] = Move();
+        stage = inCheck ? INIT_EVASIONS : INIT_CAPTURES;
+    }
+
+    // Was the move just handed out a capture that loses material?
+    bool is_bad_capture() const {
+        return stage == BAD_CAPTURES;
+    }
+
+    Move next_move() {
+        switch (stage) {
+        case HASH_MOVE:
+            stage = inCheck ? INIT_EVASIONS : INIT_CAPTURES;
+            if (is_playable(ttMove)) {
+                return ttMove;
+            }
+            return next_move();
+
+        case INIT_CAPTURES:
+            moves.clear();
+            generate<CAPTURES>(chess_board, moves);
+            for (int i = 0; i < int(moves.size()); ++i) {
+                scores[i] = mvv_lva(chess_board, moves[i]);
+            }
+            cursor = 0;
+            ++stage;
+            [[fallthrough]];
+
+        case CAPTURE_MOVES:
+            while (cursor < int(moves.size())) {
+                Move m = pick_best();
+                if (m == ttMove) {
+                    continue;
+                }
+                if (see(chess_board, m) < 0) {
+                    if (!capturesOnly) {
+                        badCaptures.push_back(m);
+                    }
+                    continue;
+                }
+                return m;
+            }
+            if (capturesOnly) {
+                stage = DONE;
+                return Move();
+            }
+            ++stage;
+            [[fallthrough]];
+
+        case KILLER_1:
+            ++stage;
+            if (killers[0] != ttMove && is_quiet(chess_board, killers[0]) && is_playable(killers[0])) {
+                return killers[0];
+            }
+            [[fallthrough]];
+
+        case KILLER_2:
+            ++stage;
+            if (killers[1] != ttMove && is_quiet(chess_board, killers[1]) && is_playable(killers[1])) {
+                return killers[1];
+            }
+            [[fallthrough]];
+
+        case COUNTER_MOVE:
+            ++stage;
+            if (is_special(counterMove)) {
+                counterMove = Move();   // so QUIET_MOVES does not skip it
+            } else if (is_quiet(chess_board, counterMove) && is_playable(counterMove)) {
+                return counterMove;
+            }
+            [[fallthrough]];
+
+        case INIT_QUIETS:
+            moves.clear();
+            generate<QUIETS>(chess_board, moves);
+            score_quiets();
+            cursor = 0;
+            ++stage;
+            [[fallthrough]];
+
+        case QUIET_MOVES:
+            while (cursor < int(moves.size())) {
+                Move m = pick_best();
+                if (m != ttMove && m != killers[0] && m != killers[1] && m != counterMove) {
+                    return m;
+                }
+            }
+            ++stage;
+            [[fallthrough]];
+
+        case BAD_CAPTURES:
+            if (badCursor < int(badCaptures.size())) {
+                return badCaptures[badCursor++];
+            }
+            stage = DONE;
+            return Move();
+
+        case INIT_EVASIONS:
+            moves.clear();
+            generate<EVASIONS>(chess_board, moves);
+            score_quiets();
+            // Captures of the checker first, above any history a quiet move can have
+            for (int i = 0; i < int(moves.size()); ++i) {
+                if (!is_quiet(chess_board, moves[i])) {
+                    scores[i] = HistoryTable::MAX + 1000 + mvv_lva(chess_board, moves[i]);
+                }
+            }
+            cursor = 0;
+            ++stage;
+            [[fallthrough]];
+
+        case EVASION_MOVES:
+            while (cursor < int(moves.size())) {
+                Move m = pick_best();
+                if (m != ttMove) {
+                    return m;
+                }
+            }
+            ++stage;
+            [[fallthrough]];
+
+        default:
+            return Move();
+        }
+    }
+
+    // Swap the best remaining move to the cursor and hand it out
+    Move pick_best() {
+        int best = cursor;
+        for (int i = cursor + 1; i < int(moves.size()); ++i) {
+            if (scores[i] > scores[best]) {
+                best = i;
+            }
+        }
+        std::swap(moves[cursor], moves[best]);
+        std::swap(scores[cursor], scores[best]);
+        return moves[cursor++];
+    }
+
+    // Quiet moves go by history; one that puts a piece where an enemy pawn
+    // can take it is pushed down, the more so the more the piece is worth
+    void score_quiets() {
+        Color us = chess_board.boardTurn;
+        Bitboard enemyPawns = chess_board.bitboards[us == White ? p : P];
+        for (int i = 0; i < int(moves.size()); ++i) {
+            int dst = moves[i].dst_square();
+            scores[i] = history ? history->get(us, moves[i]) : 0;
+            if (PawnAttacks[us][dst] & enemyPawns) {
+                scores[i] -= 1024 * OrderValue[chess_board.chessboard[moves[i].src_square()]];
+            }
+        }
+    }
+
+    // Already handed out by an earlier stage
+    bool is_special(const Move &m) const {
+        return m.is_null() || m == ttMove || m == killers[0] || m == killers[1];
+    }
+
+    // The TT and killer moves were not generated here, so check that they
+    // are legal in this position before handing them out
+    bool is_playable(const Move &m) {
+        if (!chess_board.is_pseudo_legal(m)) {
+            return false;
+        }
+        Color us = chess_board.boardTurn;
+        chess_board.make_move(m);
+        bool legal = !chess_board.isKingInCheck(us);
+        chess_board.unmake_move(m);
+        return legal;
+    }
+};
+
+#endif // MOVEPICK_HPP
@@ -6,304 +6,380 @@
 #include  "utils.hpp"
 #include <cstring>  // for memcpy if you use it
 
-// Generate all possible moves checking all rules except check
-std::vector<Move> board::generatePseudoLegalMoves() const {
-    bool isWhiteTurn = (boardTurn == White);
-    std::vector<Move> moves;
-    
-
-    //
-    // 2) Generate moves for non-pawn pieces using your attack_map approach
-    //    (pawns are skipped here, because we handled them above!)
-    //
-
-    // 1) Create local attack_map
-    std::array<Bitboard, 64> attack_map;
-    attack_map.fill(0ULL);
-
-    // 2) Calculate attacks
-    calculate_attacks(bitboards, chessboard, isWhiteTurn, attack_map);
-
-    // 3) Initialize the moves vector which will be returned
-    
+// Pieces of both colours that attack `square`, with sliders blocked by `occupied`.
+// Works backwards from the target ("superpiece"): a knight attacks the square
+// iff the square's knight pattern hits it, a white pawn iff a black pawn on
+// the square would capture it, and so on.
+inline Bitboard board::attackers_to(int square, Bitboard occupied) const {
+    return (PawnAttacks[Black][square] & bitboards[P])
+         | (PawnAttacks[White][square] & bitboards[p])
+         | (KnightAttacks[square] & (bitboards[N] | bitboards[n]))
+         | (KingAttacks[square]   & (bitboards[K] | bitboards[k]))
+         | (rook_attacks(square, occupied)   & (bitboards[R] | bitboards[r] | bitboards[Q] | bitboards[q]))
+         | (bishop_attacks(square, occupied) & (bitboards[B] | bitboards[b] | bitboards[Q] | bitboards[q]));
+}
 
-    // 4) Convert each square’s attack bitboard into Moves
-    for (int square = 0; square < 64; ++square) {
-        PieceType piece = chessboard[square];
-        if (piece == e) continue; // Skip empty squares
+// Does side `by` attack `square`? Stops at the first attacker found.
+inline bool board::is_square_attacked(int square, Color by, Bitboard occupied) const {
+    int offset = (by == White) ? 0 : 6;   // black piece types follow the white ones
+    return (PawnAttacks[by == White ? Black : White][square] & bitboards[P + offset])
+        || (KnightAttacks[square] & bitboards[N + offset])
+        || (KingAttacks[square] & bitboards[K + offset])
+        || (rook_attacks(square, occupied) & (bitboards[R + offset] | bitboards[Q + offset]))
+        || (bishop_attacks(square, occupied) & (bitboards[B + offset] | bitboards[Q + offset]));
+}
 
-        // Skip opponent’s pieces on source
-        if (isWhiteTurn && isBlackPiece(piece)) continue;
-        if (!isWhiteTurn && isWhitePiece(piece)) continue;
+inline bool board::is_square_attacked(int square, Color by) const {
+    return is_square_attacked(square, by, getOccupied());
+}
 
-        Bitboard &targets = attack_map[square];
-        while (targets) {
-            int dstSquare = popcount(targets); // popcount modifies 'targets'
-            // Debug output: print source, destination, and destination piece type
-                        
-            // Skip if destination square has a friendly piece.
-            if ((isWhiteTurn && isWhitePiece(chessboard[dstSquare])) ||
-                (!isWhiteTurn && isBlackPiece(chessboard[dstSquare]))) {
-                 
-                continue;
-            } else {
-
-            Move m((1ULL << square), (1ULL << dstSquare), '\0');
-            moves.push_back(m);
-            }
-        }
+// Is `turn`'s king attacked?
+bool board::isKingInCheck(Color turn) const {
+    Bitboard king = bitboards[(turn == White) ? K : k];
+    if (king == 0ULL) {
+        return false;
     }
+    return is_square_attacked(__builtin_ctzll(king), (turn == White) ? Black : White);
+}
 
-    // 5) Generate castling moves
-    generateCastlingMoves(moves);
-
-    // 6) Generate promotion moves
-    generatePromotions(moves);
-    generatePawnMoves(moves);
-
-    /*for(int i =0 ;i<moves.size();i++){
-        if (moves[i].src_pos == 1ULL << 15) {
-            print_bitboard(1ULL << 15);
-            std::cout << "aSasasaSa";
+// Pieces of `us` pinned to its king on `kingSquare`: the only piece standing
+// between the king and an enemy slider. They may only move along that line.
+inline Bitboard board::pinned_pieces(Color us, int kingSquare) const {
+    int theirs = (us == White) ? 6 : 0;
+    Bitboard friends  = getOccupiedByColor(us == White);
+    Bitboard enemies  = getOccupiedByColor(us != White);
+    Bitboard occupied = friends | enemies;
+
+    Bitboard pinned = 0ULL;
+    Bitboard snipers = (rook_attacks(kingSquare, enemies) & (bitboards[R + theirs] | bitboards[Q + theirs]))
+                     | (bishop_attacks(kingSquare, enemies) & (bitboards[B + theirs] | bitboards[Q + theirs]));
+    while (snipers) {
+        Bitboard blockers = BetweenSquares[kingSquare][popcount(snipers)] & occupied;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & friends)) {
+            pinned |= blockers;
         }
+    }
+    return pinned;
+}
 
-    }*/
-
-    return moves;
+// Would taking en passant with the pawn on `src` uncover a slider on our
+// king? The move empties two squares of a rank or diagonal at once, which
+// pinned_pieces() cannot see.
+inline bool board::en_passant_exposes_king(int src, int kingSquare) const {
+    int theirs   = (boardTurn == White) ? 6 : 0;
+    int captured = en_passant_square + ((boardTurn == White) ? -8 : 8);
+    Bitboard after = (getOccupied() ^ (1ULL << src) ^ (1ULL << captured)) | (1ULL << en_passant_square);
+    return (rook_attacks(kingSquare, after) & (bitboards[R + theirs] | bitboards[Q + theirs]))
+        || (bishop_attacks(kingSquare, after) & (bitboards[B + theirs] | bitboards[Q + theirs]));
 }
 
-// Check if current player is in check
-bool check_for_check(board b){
-    std::vector<Move> Moves = b.generatePseudoLegalMoves();
-    for (auto & move : Moves) {
-        if (move.dst_pos == b.EnemykingPosition()) {
-            return true;
-        }
+// Add a pawn move, expanded into the four promotions when it reaches the last rank
+inline void add_pawn_move(MoveList &moves, int src, int dst) {
+    if (dst >= 56 || dst < 8) {
+        moves.emplace_back(src, dst, PROMOTION_QUEEN);
+        moves.emplace_back(src, dst, PROMOTION_ROOK);
+        moves.emplace_back(src, dst, PROMOTION_BISHOP);
+        moves.emplace_back(src, dst, PROMOTION_KNIGHT);
+    } else {
+        moves.emplace_back(src, dst);
     }
-    return false;
-};
-
-// Make a copy of the board and apply a move
-board PeekMove(const board &Board, const Move &move) {
-    board Board1;
-    // Copy the entire board structure
-    std::memcpy(&Board1, &Board, sizeof(Board));
-    Board1.apply_move(move);
-    return Board1;
 }
 
-// Generate only legal moves (i.e., exclude moves that leave your king in check)
-std::vector<Move> board::generateLegalMoves() const {
-    std::vector<Move> legal_moves;
-
-    // Generate all pseudo-legal moves
-    std::vector<Move> pseudo = this->generatePseudoLegalMoves();
-    for (const auto& mv : pseudo) {
-        board next_board = PeekMove(*this, mv);
-        if (!check_for_check(next_board)) {
-            legal_moves.push_back(mv);
+// Append the legal moves of kind T (LEGAL, CAPTURES or QUIETS).
+// Checkers, pinned pieces and the squares the enemy attacks are worked out
+// once for the position, and each piece's targets are masked with them, so no
+// move ever has to be tried on the board.
+// "Captures" are the moves that change material: captures, en passant and
+// every promotion. The rest (including castling) are quiet. Search asks for
+// the two groups separately so it does not generate quiet moves at nodes that
+// cut off on a capture. T is a template argument so the unused branches are
+// compiled out.
+template <MoveType T>
+void board::generate(MoveList &moves) const {
+    static_assert(T == LEGAL || T == CAPTURES || T == QUIETS, "EVASIONS is specialised");
+    constexpr bool captures = (T != QUIETS);
+    constexpr bool quiets   = (T != CAPTURES);
+
+    Color us   = boardTurn;
+    Color them = (us == White) ? Black : White;
+    int ours   = (us == White) ? 0 : 6;
+
+    Bitboard friends  = getOccupiedByColor(us == White);
+    Bitboard enemies  = getOccupiedByColor(us != White);
+    Bitboard occupied = friends | enemies;
+
+    // Destinations allowed for every piece but pawns, which sort themselves
+    Bitboard targetMask = (captures ? enemies : 0ULL) | (quiets ? ~occupied : 0ULL);
+
+    Bitboard kingBB = bitboards[K + ours];
+    if (kingBB == 0ULL) {
+        return;
+    }
+    int kingSquare = __builtin_ctzll(kingBB);
+
+    // 1) Enemy pieces giving check
+    Bitboard checkers = attackers_to(kingSquare, occupied) & enemies;
+
+    // 2) King moves, never onto an attacked square. The king is taken off the
+    //    board first so it cannot step back along the line of a checking slider.
+    Bitboard targets = KingAttacks[kingSquare] & targetMask;
+    while (targets) {
+        int dst = popcount(targets);
+        if (!is_square_attacked(dst, them, occupied ^ kingBB)) {
+            moves.emplace_back(kingSquare, dst);
         }
     }
-    
-
 
+    // In double check only the king can move
+    if (checkers & (checkers - 1)) {
+        return;
+    }
 
-    return legal_moves;
-}
+    // 3) Squares that answer a single check: capture the checker or block its line
+    Bitboard checkMask = ~0ULL;
+    if (checkers) {
+        checkMask = checkers | BetweenSquares[kingSquare][__builtin_ctzll(checkers)];
+    }
 
-void board::generateCastlingMoves(std::vector<Move>& moves) const{
-    // If the king has moved already, no castling
-    if (King_moved) return;
+    // 4) Pinned pieces, which may only move along the line to our king
+    Bitboard pinned = pinned_pieces(us, kingSquare);
 
-    // If the kingside rook has moved or the alley is blocked, skip kingside
-    if (!(Rook_KingSide_moved || Occupied_KingSide_Castling_Alley)) {
-        if (boardTurn == White) {
-            // White king from e1 -> g1
-            Move m(White_King_square, WhiteRookKingSideSquare, '\0', /*is_castling=*/true);
-            moves.push_back(m);
-        } else {
-            // Black king from e8 -> g8
-            Move m(Black_King_square, BlackRookKingSideSquare, '\0', /*is_castling=*/true);
-            moves.push_back(m);
+    // 5) Knights, bishops, rooks and queens
+    Bitboard pieces = friends & ~bitboards[P + ours] & ~kingBB;
+    while (pieces) {
+        int src = popcount(pieces);
+        targets = piece_attacks(chessboard[src], src, occupied) & targetMask & checkMask;
+        if (pinned & (1ULL << src)) {
+            targets &= LineThrough[kingSquare][src];
+        }
+        while (targets) {
+            moves.emplace_back(src, popcount(targets));
         }
     }
 
-    // If the queenside rook has moved or the alley is blocked, skip queenside
-    if (!(Rook_QueenSide_moved || Occupied_QueenSide_Castling_Alley)) {
-        if (boardTurn == White) {
-            // White king from e1 -> c1
-            Move m(White_King_square, WhiteRookQueenSideSquare, '\0', /*is_castling=*/true);
-            moves.push_back(m);
-        } else {
-            // Black king from e8 -> c8
-            Move m(Black_King_square, BlackRookQueenSideSquare, '\0', /*is_castling=*/true);
-            moves.push_back(m);
+    // 6) Pawns: pushes, double pushes, captures and promotions
+    int up = (us == White) ? 8 : -8;
+    Bitboard doublePushRank = (us == White) ? 0x0000000000FF0000ULL : 0x0000FF0000000000ULL; // rank 3 / rank 6
+    Bitboard pawns = bitboards[P + ours];
+    while (pawns) {
+        int src = popcount(pawns);
+        Bitboard allowed = checkMask;
+        if (pinned & (1ULL << src)) {
+            allowed &= LineThrough[kingSquare][src];
         }
-    }
-}
 
+        // A push is quiet unless it promotes
+        int one = src + up;
+        if (!(occupied & (1ULL << one))) {
+            bool promotes = (one >= 56 || one < 8);
+            if ((promotes ? captures : quiets) && (allowed & (1ULL << one))) {
+                add_pawn_move(moves, src, one);
+            }
+            int two = one + up;
+            if (quiets && (doublePushRank & (1ULL << one)) && !(occupied & (1ULL << two)) && (allowed & (1ULL << two))) {
+                moves.emplace_back(src, two);
+            }
+        }
+
+        if constexpr (!captures) {
+            continue;
+        }
+
+        targets = PawnAttacks[us][src] & enemies & allowed;
+        while (targets) {
+            add_pawn_move(moves, src, popcount(targets));
+        }
 
-/*
-void board::generatePromotions(std::vector<Move>& moves) const{
-    // White promotions
-    if (boardTurn == White) {
-        // Check if any white pawns are on rank 7
-        Bitboard pawns_on_7 = bitboards[P] & RANK_7;
-        while (pawns_on_7) {
-            int sq = popcount(pawns_on_7); // popcount modifies pawns_on_7
-            int next_sq = sq + 8;         // Move from rank 7 to rank 8
-            if (next_sq < 64) {
-                // Add promotion moves: (Q, R, B, N)
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'q');
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'r');
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'b');
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'n');
+        // En passant takes a pawn that is not on the target square, so test it
+        // directly: it must answer any check, and removing both pawns from
+        // their rank or diagonal must not uncover a slider on our king.
+        if (en_passant_square != -1 && (PawnAttacks[us][src] & (1ULL << en_passant_square))) {
+            int captured = en_passant_square - up;
+            bool answersCheck = (checkMask & (1ULL << en_passant_square)) || (checkers & (1ULL << captured));
+            if (answersCheck && !en_passant_exposes_king(src, kingSquare)) {
+                moves.emplace_back(src, en_passant_square, EN_PASSANT);
             }
         }
     }
-    // Black promotions
-    else {
-        // Check if any black pawns are on rank 2
-        Bitboard pawns_on_2 = bitboards[p] & RANK_2;
-        while (pawns_on_2) {
-            int sq = popcount(pawns_on_2);
-            int next_sq = sq - 8; // Move from rank 2 to rank 1
-            if (next_sq >= 0) {
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'q');
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'r');
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'b');
-                moves.emplace_back((1ULL << sq), (1ULL << next_sq), 'n');
+
+    // 7) Castling: not out of check, and the king may not cross an attacked square
+    if (quiets && !checkers) {
+        if (us == White) {
+            if ((castling_rights & WHITE_OO) && (bitboards[R] & WhiteRookKingSideSquare) &&
+                !(occupied & WhiteRookKingSideAlley) &&
+                !is_square_attacked(5, them, occupied) && !is_square_attacked(6, them, occupied)) {
+                moves.emplace_back(4, 6, CASTLING);
+            }
+            if ((castling_rights & WHITE_OOO) && (bitboards[R] & WhiteRookQueenSideSquare) &&
+                !(occupied & WhiteRookQueenSideAlley) &&
+                !is_square_attacked(3, them, occupied) && !is_square_attacked(2, them, occupied)) {
+                moves.emplace_back(4, 2, CASTLING);
+            }
+        } else {
+            if ((castling_rights & BLACK_OO) && (bitboards[r] & BlackRookKingSideSquare) &&
+                !(occupied & BlackRookKingSideAlley) &&
+                !is_square_attacked(61, them, occupied) && !is_square_attacked(62, them, occupied)) {
+                moves.emplace_back(60, 62, CASTLING);
+            }
+            if ((castling_rights & BLACK_OOO) && (bitboards[r] & BlackRookQueenSideSquare) &&
+                !(occupied & BlackRookQueenSideAlley) &&
+                !is_square_attacked(59, them, occupied) && !is_square_attacked(58, them, occupied)) {
+                moves.emplace_back(60, 58, CASTLING);
             }
         }
     }
 }
-*/
-
-
-
-void board::generatePromotions(std::vector<Move>& moves) const {
-    // White promotions
-    if (boardTurn == White) {
-        // Check if any white pawns are on rank 7 using the RANK_7 mask
-        Bitboard pawns_on_7 = bitboards[P] & RANK_7;
-        while (pawns_on_7) {
-            int sq = popcount(pawns_on_7);  // Get and clear one pawn position on rank 7
-            int next_sq = sq + 8;           // Destination square one rank ahead (promotion square)
-            // Only add promotion moves if the destination is on board and empty
-            if (next_sq < 64 && chessboard[next_sq] == e) {
-                Bitboard cur = (1ULL << sq);
-                Bitboard next =  (1ULL << next_sq);
-
-                Bitboard c = valid_pawn_captures(cur, (boardTurn == White), this->opponentPieces());
-
-                moves.emplace_back(cur ,next , 'q');
-                moves.emplace_back(cur ,next , 'r');
-                moves.emplace_back(cur ,next , 'b');
-                moves.emplace_back(cur ,next , 'n');
-
-                while(c){
-                    int i = popcount(c);
-                    moves.emplace_back(cur ,(1ULL << i) , 'q');
-                    moves.emplace_back(cur ,(1ULL << i) , 'r');
-                    moves.emplace_back(cur ,(1ULL << i) , 'b');
-                    moves.emplace_back(cur ,(1ULL << i) , 'n');
-                }
-            }
+
+// Replies to check: king steps, captures of the checker and, against a
+// slider, blocks. Pinned pieces can never do either, so they are skipped.
+template <>
+inline void board::generate<EVASIONS>(MoveList &moves) const {
+    Color us   = boardTurn;
+    Color them = (us == White) ? Black : White;
+    int ours   = (us == White) ? 0 : 6;
+
+    Bitboard friends  = getOccupiedByColor(us == White);
+    Bitboard enemies  = getOccupiedByColor(us != White);
+    Bitboard occupied = friends | enemies;
+    Bitboard kingBB   = bitboards[K + ours];
+    int kingSquare    = __builtin_ctzll(kingBB);
+
+    Bitboard checkers = attackers_to(kingSquare, occupied) & enemies;
+    assert(checkers && "generate<EVASIONS> needs the side to move in check");
+
+    Bitboard targets = KingAttacks[kingSquare] & ~friends;
+    while (targets) {
+        int dst = popcount(targets);
+        if (!is_square_attacked(dst, them, occupied ^ kingBB)) {
+            moves.emplace_back(kingSquare, dst);
         }
     }
-    // Black promotions
-    else {
-        // Check if any black pawns are on rank 2 using the RANK_2 mask
-        Bitboard pawns_on_2 = bitboards[p] & RANK_2;
-        while (pawns_on_2) {
-            int sq = popcount(pawns_on_2);  // Get and clear one pawn position on rank 2
-            int next_sq = sq - 8;           // Destination square one rank down (promotion square)
-            // Only add promotion moves if the destination is on board and empty
-            if (next_sq >= 0 && chessboard[next_sq] == e) {
-                Bitboard cur = (1ULL << sq);
-                Bitboard next =  (1ULL << next_sq);
-
-                Bitboard c = valid_pawn_captures(cur, (boardTurn == White), this->opponentPieces());
-
-                moves.emplace_back(cur ,next , 'q');
-                moves.emplace_back(cur ,next , 'r');
-                moves.emplace_back(cur ,next , 'b');
-                moves.emplace_back(cur ,next , 'n');
-
-                while(c){
-                    int i = popcount(c);
-                    moves.emplace_back(cur ,(1ULL << i) , 'q');
-                    moves.emplace_back(cur ,(1ULL << i) , 'r');
-                    moves.emplace_back(cur ,(1ULL << i) , 'b');
-                    moves.emplace_back(cur ,(1ULL << i) , 'n');
-                }
-            }
-        }
+
+    // In double check only the king can move
+    if (checkers & (checkers - 1)) {
+        return;
     }
-}
 
+    int checkerSquare = __builtin_ctzll(checkers);
+    Bitboard blocks   = BetweenSquares[kingSquare][checkerSquare];
+    Bitboard answers  = checkers | blocks;
+    Bitboard pinned   = pinned_pieces(us, kingSquare);
 
-void board::generatePawnMoves(std::vector<Move>& moves) const {
-    bool isWhiteTurn = (boardTurn == White);
-    int direction = isWhiteTurn ? 8 : -8;  // north for White, south for Black
-    Bitboard pawns = isWhiteTurn ? bitboards[P] : bitboards[p];
+    Bitboard pieces = friends & ~bitboards[P + ours] & ~kingBB & ~pinned;
+    while (pieces) {
+        int src = popcount(pieces);
+        targets = piece_attacks(chessboard[src], src, occupied) & answers;
+        while (targets) {
+            moves.emplace_back(src, popcount(targets));
+        }
+    }
 
+    int up = (us == White) ? 8 : -8;
+    Bitboard doublePushRank = (us == White) ? 0x0000000000FF0000ULL : 0x0000FF0000000000ULL; // rank 3 / rank 6
+    Bitboard pawns = bitboards[P + ours] & ~pinned;
     while (pawns) {
-        int srcSq = __builtin_ctzll(pawns);
-        pawns &= pawns - 1;  // remove the pawn we're processing
-
-        // Single forward move
-        int dstSq = srcSq + direction;
-        if (dstSq >= 0 && dstSq < 64 && chessboard[dstSq] == e) {
-            // If moving into promotion rank, skip here, handled by promotions
-            if ((isWhiteTurn && (dstSq / 8 == 7)) || (!isWhiteTurn && (dstSq / 8 == 0))) {
-                // Promotion moves are handled separately in generatePromotions
-            } else {
-                moves.emplace_back((1ULL << srcSq), (1ULL << dstSq), '\0');
-            }
+        int src = popcount(pawns);
 
-            // Double forward move from starting rank
-            int startRank = isWhiteTurn ? 1 : 6;
-            if ((srcSq / 8) == startRank) {
-                int dstSq2 = srcSq + 2 * direction;
-                if (chessboard[dstSq2] == e) {
-                    moves.emplace_back((1ULL << srcSq), (1ULL << dstSq2), '\0');
-                }
+        // Pushes can only block
+        int one = src + up;
+        if (!(occupied & (1ULL << one))) {
+            if (blocks & (1ULL << one)) {
+                add_pawn_move(moves, src, one);
+            }
+            int two = one + up;
+            if ((doublePushRank & (1ULL << one)) && (blocks & (1ULL << two)) && !(occupied & (1ULL << two))) {
+                moves.emplace_back(src, two);
             }
         }
 
-        // Captures: diagonally forward moves
-        for (int df = -1; df <= 1; df += 2) {  // file shift: -1 (west), +1 (east)
-            int captureSq = srcSq + direction + df;
-            if (captureSq >= 0 && captureSq < 64) {
-                // Ensure the move stays on board (prevent wrap-around due to file changes)
-                if ((df == -1 && srcSq % 8 == 0) || (df == 1 && srcSq % 8 == 7))
-                    continue;
-
-                PieceType target = chessboard[captureSq];
-                if (target != e && ((isWhiteTurn && isBlackPiece(target)) || (!isWhiteTurn && isWhitePiece(target)))) {
-                    // If moving into promotion rank, skip here, handled by promotions
-                    if ((isWhiteTurn && (captureSq / 8 == 7)) || (!isWhiteTurn && (captureSq / 8 == 0))) {
-                        // Promotion captures handled in generatePromotions
-                    } else {
-                        moves.emplace_back((1ULL << srcSq), (1ULL << captureSq), '\0');
-                    }
-                }
-
-                // En passant capture logic could be added here if needed
+        if (PawnAttacks[us][src] & checkers) {
+            add_pawn_move(moves, src, checkerSquare);
+        }
+
+        // En passant answers a check by the pawn it takes, or blocks with the
+        // capturing pawn; as in generate<LEGAL> it must not uncover the king
+        if (en_passant_square != -1 && (PawnAttacks[us][src] & (1ULL << en_passant_square))) {
+            int captured = en_passant_square - up;
+            bool answersCheck = (blocks & (1ULL << en_passant_square)) || (checkers & (1ULL << captured));
+            if (answersCheck && !en_passant_exposes_king(src, kingSquare)) {
+                moves.emplace_back(src, en_passant_square, EN_PASSANT);
             }
         }
     }
 }
 
+// Free-function form, e.g. generate<CAPTURES>(chess_board, moves)
+template <MoveType T>
+inline void generate(const board &chess_board, MoveList &moves) {
+    chess_board.generate<T>(moves);
+}
+
+MoveList board::generateLegalMoves() const {
+    MoveList moves;
+    generate<LEGAL>(moves);
+    return moves;
+}
+
+// Could `m` be played here, ignoring whether it leaves our king in check?
+// Used to vet moves that come from somewhere other than this position's move
+// list: the transposition table and the killer slots.
+bool board::is_pseudo_legal(const ::Move &m) const {
+    if (m.is_null()) {
+        return false;
+    }
+
+    Color us = boardTurn;
+    int src = m.src_square();
+    int dst = m.dst_square();
+    Bitboard dstBB = 1ULL << dst;
+    PieceType pt = chessboard[src];
+    int ours = (us == White) ? 0 : 6;
 
+    if (pt == e || (pt < p) != (us == White) || (friendPieces() & dstBB)) {
+        return false;
+    }
 
-    
+    // Castling has too many conditions to repeat here, and is rare enough
+    // to simply look for among the generated quiet moves
+    if (m.is_castling()) {
+        MoveList quietMoves;
+        generate<QUIETS>(quietMoves);
+        for (const ::Move &q : quietMoves) {
+            if (q == m) return true;
+        }
+        return false;
+    }
 
+    Bitboard occupied = getOccupied();
+    if (pt == P + ours) {
+        if (m.is_en_passant()) {
+            return dst == en_passant_square && (PawnAttacks[us][src] & dstBB);
+        }
+        if (m.is_promotion() != (dst >= 56 || dst < 8)) {
+            return false;
+        }
+        if (PawnAttacks[us][src] & dstBB) {
+            return (opponentPieces() & dstBB) != 0ULL;
+        }
+        int up = (us == White) ? 8 : -8;
+        if (dst == src + up) {
+            return !(occupied & dstBB);
+        }
+        int startRank = (us == White) ? 1 : 6;
+        return dst == src + 2 * up && src / 8 == startRank &&
+               !(occupied & ((1ULL << (src + up)) | dstBB));
+    }
+
+    if (m.flag() != NORMAL) {
+        return false;
+    }
+
+    return (piece_attacks(pt, src, occupied) & dstBB) != 0ULL;
+}
 
 Move board::generateRandomLegalMove() const {
     // Generate all legal moves
-    std::vector<Move> legal_moves = this->generateLegalMoves();
+    MoveList legal_moves = this->generateLegalMoves();
 
     // If no legal moves are available (e.g., checkmate or stalemate), return an empty move
     if (legal_moves.empty()) {
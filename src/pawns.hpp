@@ -0,0 +1,142 @@
+#ifndef PAWNS_HPP
+#define PAWNS_HPP
+
+#include <stdint.h>
+
+#include "board.hpp"
+#include "psqt.hpp"
+#include "utils.hpp"
+#include "zobrist.hpp"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Pawn structure evaluation and its cache.
+//
+// Everything here depends on the pawns alone, which hardly change between
+// neighbouring nodes, so the result is stored under board::pawnKey (the
+// Zobrist key of the pawns only) and looked up instead of recomputed.
+// Each search thread has its own table, so no locking is needed.
+//
+// An entry holds the pawn score (doubled, isolated and passed pawns, as a
+// midgame/endgame Score from White's point of view) and, per colour, a
+// bit per file that has a pawn of that colour; the rook-file and king
+// terms of the evaluation read those instead of looking at the pawns.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+inline constexpr Bitboard FileMask[8] = {
+    0x0101010101010101ULL << 0, 0x0101010101010101ULL << 1,
+    0x0101010101010101ULL << 2, 0x0101010101010101ULL << 3,
+    0x0101010101010101ULL << 4, 0x0101010101010101ULL << 5,
+    0x0101010101010101ULL << 6, 0x0101010101010101ULL << 7
+};
+
+// Squares in front of a pawn, on its own and the neighbouring files, where
+// an enemy pawn would stop it from being passed
+struct PassedMaskTable {
+    Bitboard masks[2][64] = {};
+
+    constexpr PassedMaskTable() {
+        for (int sq = 0; sq < 64; ++sq) {
+            int file = sq % 8, rank = sq / 8;
+            for (int f = file - 1; f <= file + 1; ++f) {
+                if (f < 0 || f > 7) continue;
+                for (int r = rank + 1; r < 8; ++r) masks[White][sq] |= 1ULL << (r * 8 + f);
+                for (int r = rank - 1; r >= 0; --r) masks[Black][sq] |= 1ULL << (r * 8 + f);
+            }
+        }
+    }
+};
+
+inline constexpr PassedMaskTable PassedMasks;
+
+// Pawn terms, by the pawn's rank counted from its own side for passers
+inline constexpr Score DoubledPawn  = make_score(-10, -20);   // per extra pawn on a file
+inline constexpr Score IsolatedPawn = make_score(-10, -15);
+inline constexpr Score PassedPawn[8] = {
+    make_score(0, 0),   make_score(5, 10),  make_score(10, 15), make_score(15, 25),
+    make_score(25, 40), make_score(40, 65), make_score(60, 100), make_score(0, 0)
+};
+
+struct PawnEntry {
+    Key key;
+    Score score;           // White's point of view
+    uint8_t files[2];      // bit f: this colour has a pawn on file f
+
+    // Every square of the files with no pawn of `side`, or with no pawn at all
+    Bitboard semi_open_files(Color side) const {
+        return file_span(uint8_t(~files[side]));
+    }
+
+    Bitboard open_files() const {
+        return file_span(uint8_t(~(files[White] | files[Black])));
+    }
+
+    // Copy a byte of file bits up to all eight ranks
+    static Bitboard file_span(uint8_t fileBits) {
+        return Bitboard(fileBits) * 0x0101010101010101ULL;
+    }
+};
+
+// Pawn structure of `chess_board` from scratch
+inline PawnEntry evaluate_pawns(const board &chess_board) {
+    PawnEntry entry{};
+    entry.key = chess_board.pawnKey;
+
+    for (Color side : {White, Black}) {
+        Bitboard ours   = chess_board.bitboards[side == White ? P : p];
+        Bitboard theirs = chess_board.bitboards[side == White ? p : P];
+        Score score = 0;
+
+        for (int file = 0; file < 8; ++file) {
+            int count = __builtin_popcountll(ours & FileMask[file]);
+            if (count == 0) continue;
+
+            entry.files[side] |= uint8_t(1 << file);
+            score += DoubledPawn * (count - 1);
+
+            Bitboard neighbours = (file > 0 ? FileMask[file - 1] : 0) | (file < 7 ? FileMask[file + 1] : 0);
+            if (!(ours & neighbours)) {
+                score += IsolatedPawn * count;
+            }
+        }
+
+        for (Bitboard pawns = ours; pawns; pawns &= pawns - 1) {
+            int sq = __builtin_ctzll(pawns);
+            if (!(PassedMasks.masks[side][sq] & theirs)) {
+                int relativeRank = (side == White) ? sq / 8 : 7 - sq / 8;
+                score += PassedPawn[relativeRank];
+            }
+        }
+
+        entry.score += (side == White) ? score : -score;
+    }
+    return entry;
+}
+
+struct PawnTable {
+    static constexpr size_t SIZE = 1 << 14;   // entries, a power of two
+
+    PawnEntry entries[SIZE];
+
+    PawnTable() { clear(); }
+
+    // The entry for this pawn structure, computed first if it is not cached
+    const PawnEntry &probe(const board &chess_board) {
+        PawnEntry &entry = entries[chess_board.pawnKey & (SIZE - 1)];
+        if (entry.key != chess_board.pawnKey) {
+            entry = evaluate_pawns(chess_board);
+        }
+        return entry;
+    }
+
+    // Key 0 is the position without pawns, whose entry is all zero anyway
+    void clear() {
+        for (PawnEntry &entry : entries) {
+            entry = PawnEntry{};
+        }
+    }
+};
+
+// The PawnTable of each search thread
+inline PerThread<PawnTable> PawnTables;
+
+#endif // PAWNS_HPP
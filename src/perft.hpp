@@ -0,0 +1,179 @@
+#ifndef PERFT_HPP
+#define PERFT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+#include "board.hpp"
+#include "moves.hpp"
+#include "utils.hpp"
+#include "zobrist.hpp"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Perft: count the leaf nodes of the legal move tree to a fixed depth.
+// Used both to check the move generator against published counts and to
+// measure raw generateLegalMoves + make/unmake speed.
+//
+// The root moves are shared out to worker threads, one move at a time, and
+// each worker walks its subtree on its own copy of the board. At the last
+// ply the legal moves are counted, not made.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Optional cache of subtree counts, shared by all workers. Same lock-free
+// scheme as the transposition table: an entry is valid only if its check
+// word equals key ^ nodes, so a torn write is read as a miss.
+struct PerftHash {
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> nodes;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slot_count;
+
+    explicit PerftHash(size_t mb) {
+        slot_count = std::max<size_t>(1, mb * 1024 * 1024 / sizeof(Slot));
+        slots.reset(new Slot[slot_count]);
+        for (size_t i = 0; i < slot_count; ++i) {
+            slots[i].check.store(0, std::memory_order_relaxed);
+            slots[i].nodes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // The same position at a different depth has a different count
+    static Key depth_key(Key key, int depth) {
+        return key ^ (uint64_t(depth) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    bool probe(Key key, int depth, uint64_t &nodes) const {
+        Key k = depth_key(key, depth);
+        const Slot &s = slots[k % slot_count];
+        uint64_t n = s.nodes.load(std::memory_order_relaxed);
+        if ((s.check.load(std::memory_order_relaxed) ^ n) == k && n != 0) {
+            nodes = n;
+            return true;
+        }
+        return false;
+    }
+
+    void store(Key key, int depth, uint64_t nodes) {
+        Key k = depth_key(key, depth);
+        Slot &s = slots[k % slot_count];
+        s.nodes.store(nodes, std::memory_order_relaxed);
+        s.check.store(k ^ nodes, std::memory_order_relaxed);
+    }
+};
+
+// Leaf count below `chess_board` at `depth`; `hash` may be null
+inline uint64_t perft(board &chess_board, int depth, PerftHash *hash) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    uint64_t nodes = 0;
+    if (hash && depth > 1 && hash->probe(chess_board.key, depth, nodes)) {
+        return nodes;
+    }
+
+    MoveList moves = chess_board.generateLegalMoves();
+    if (depth == 1) {
+        return moves.size();   // bulk count: no need to make the last ply
+    }
+
+    for (const Move &m : moves) {
+        chess_board.make_move(m);
+        nodes += perft(chess_board, depth - 1, hash);
+        chess_board.unmake_move(m);
+    }
+
+    if (hash) {
+        hash->store(chess_board.key, depth, nodes);
+    }
+    return nodes;
+}
+
+// Nodes per second, guarding against a zero-length run
+inline uint64_t perft_nps(uint64_t nodes, long long us) {
+    return nodes * 1000000 / uint64_t(std::max(1LL, us));
+}
+
+// Run perft on `chess_board` with `threads` workers and print the result.
+// With `divide` every root move is listed with its count, time and speed.
+// `hashMB` of 0 turns the perft hash off. Returns the total node count.
+inline uint64_t run_perft(const board &chess_board, int depth, bool divide,
+                          int threads, size_t hashMB, std::ostream &out = std::cout) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsed_us = [](Clock::time_point since) {
+        return (long long)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count();
+    };
+
+    Clock::time_point start = Clock::now();
+    MoveList moves = chess_board.generateLegalMoves();
+    int rootCount = int(moves.size());
+
+    if (depth < 1) {
+        out << "\nNodes searched: 1\n" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<PerftHash> hash;
+    if (hashMB > 0 && depth > 2) {
+        hash.reset(new PerftHash(hashMB));
+    }
+
+    // Per root move results, filled in by whichever worker takes the move
+    std::vector<uint64_t> nodes(rootCount, 0);
+    std::vector<long long> times(rootCount, 0);   // microseconds
+    std::atomic<int> next{0};
+
+    auto worker = [&]() {
+        board local = chess_board;
+        local.undo_count = 0;
+        for (int i = next++; i < rootCount; i = next++) {
+            Clock::time_point moveStart = Clock::now();
+            local.make_move(moves[i]);
+            nodes[i] = perft(local, depth - 1, hash.get());
+            local.unmake_move(moves[i]);
+            times[i] = elapsed_us(moveStart);
+        }
+    };
+
+    threads = std::max(1, std::min(threads, rootCount));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &th : pool) {
+        th.join();
+    }
+
+    long long us = elapsed_us(start);
+    uint64_t total = 0;
+    for (int i = 0; i < rootCount; ++i) {
+        total += nodes[i];
+        if (divide) {
+            out << moveToAlgebraic(moves[i]) << ": " << nodes[i]
+                << "  (" << times[i] / 1000 << " ms, " << perft_nps(nodes[i], times[i]) << " nps)\n";
+        }
+    }
+
+    out << "\nNodes searched: " << total
+        << "\nTime: " << us / 1000 << " ms"
+        << "\nNPS: " << perft_nps(total, us)
+        << "\nThreads: " << threads << (hash ? ", hash " + std::to_string(hashMB) + " MB" : std::string())
+        << "\n" << std::endl;
+    return total;
+}
+
+// Workers to use when the caller does not say
+inline int default_perft_threads() {
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw ? int(hw) : 1;
+}
+
+#endif // PERFT_HPP
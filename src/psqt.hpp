@@ -0,0 +1,235 @@
+#ifndef PSQT_HPP
+#define PSQT_HPP
+
+#include <stdint.h>
+#include "utils.hpp"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Material and piece-square tables, and the packed score the board keeps
+// of them (see board::psq). Every piece contributes PSQT[piece][square],
+// positive for White and negative for Black, so the total is updated with
+// one addition or subtraction whenever a piece is put down, taken off or
+// moved, instead of being summed over the board at every leaf.
+//
+// A Score holds a midgame and an endgame value in one int: the endgame half
+// in the upper 16 bits, the midgame half in the lower 16 (borrowing from the
+// upper half when negative). Adding two Scores adds both halves at once.
+// The tables have no separate endgame values yet, so both halves are equal.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+typedef int32_t Score;
+
+constexpr Score make_score(int mg, int eg) {
+    return Score(int32_t(uint32_t(eg) << 16) + mg);
+}
+
+constexpr int mg_value(Score s) {
+    return int16_t(uint16_t(uint32_t(s)));
+}
+
+// Round the upper half back up when the lower one borrowed from it
+constexpr int eg_value(Score s) {
+    return int16_t(uint16_t((uint32_t(s) + 0x8000) >> 16));
+}
+
+// Piece values for White & Black pieces.
+// Indexing:  0=P,1=R,2=N,3=B,4=Q,5=K, 6=p,7=r,8=n,9=b,10=q,11=k
+inline constexpr int PieceValue[12] = {
+    /* P */  100,
+    /* R */  500,
+    /* N */  320,
+    /* B */  330,
+    /* Q */  900,
+    /* K */  10000,
+
+    /* p */  100,
+    /* r */  500,
+    /* n */  320,
+    /* b */  330,
+    /* q */  900,
+    /* k */  10000
+};
+
+//==================================================
+// 1) White Piece-Square Tables
+//==================================================
+
+// White Pawn PST
+inline constexpr int WhitePawnPST[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,   // rank0 (a1..h1)
+     5, 10, 10,-20,-20, 10, 10,  5,   // rank1
+     5, -5, -5,  0,  0, -5, -5,  5,   // rank2
+     0,  0,  0, 20, 20,  0,  0,  0,   // rank3
+     5,  5, 10, 25, 25, 10,  5,  5,   // rank4
+    10, 10, 20, 30, 30, 20, 10, 10,   // rank5
+    50, 50, 50, 50, 50, 50, 50, 50,   // rank6
+     0,  0,  0,  0,  0,  0,  0,  0    // rank7
+};
+
+// White Knight PST
+inline constexpr int WhiteKnightPST[64] = {
+    -50,-40,-30,-30,-30,-30,-40,-50,
+    -40,-20,  0,  0,  0,  0,-20,-40,
+    -30,  0, 10, 15, 15, 10,  0,-30,
+    -30,  5, 15, 20, 20, 15,  5,-30,
+    -30,  0, 15, 20, 20, 15,  0,-30,
+    -30,  5, 10, 15, 15, 10,  5,-30,
+    -40,-20,  0,  5,  5,  0,-20,-40,
+    -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+// White Bishop PST
+inline constexpr int WhiteBishopPST[64] = {
+    -20,-10,-10,-10,-10,-10,-10,-20,
+    -10,  5,  0,  0,  0,  0,  5,-10,
+    -10, 10, 10, 10, 10, 10, 10,-10,
+    -10,  0, 10, 10, 10, 10,  0,-10,
+    -10,  5,  5, 10, 10,  5,  5,-10,
+    -10,  0,  5, 10, 10,  5,  0,-10,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+// White Rook PST
+inline constexpr int WhiteRookPST[64] = {
+      0,  0,  5, 10, 10,  5,  0,  0,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+      5, 10, 10, 10, 10, 10, 10,  5,
+      0,  0,  5, 10, 10,  5,  0,  0
+};
+
+// White Queen PST
+inline constexpr int WhiteQueenPST[64] = {
+    -20,-10,-10, -5, -5,-10,-10,-20,
+    -10,  0,  5,  0,  0,  0,  0,-10,
+    -10,  5,  5,  5,  5,  5,  0,-10,
+     -5,  0,  5,  5,  5,  5,  0, -5,
+      0,  0,  5,  5,  5,  5,  0, -5,
+    -10,  5,  5,  5,  5,  5,  0,-10,
+    -10,  0,  5,  0,  0,  0,  0,-10,
+    -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+// White King PST (middle game, for example)
+inline constexpr int WhiteKingPST[64] = {
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+     20, 20,  0,  0,  0,  0, 20, 20,
+     20, 30, 10,  0,  0, 10, 30, 20
+};
+
+//==================================================
+// 2) Black Piece-Square Tables (mirrored versions)
+//==================================================
+// The logic here is to flip the White PST so rank0 in the white array
+// becomes rank7 in the black array, rank1 -> rank6, etc.
+// We do not multiply by -1 because the sign is already accounted for
+// when PSQT below is built.
+
+// Black Pawn PST
+inline constexpr int BlackPawnPST[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,   // rank0 for black = rank7 for white
+    50, 50, 50, 50, 50, 50, 50, 50,   // rank1 for black = rank6 for white
+    10, 10, 20, 30, 30, 20, 10, 10,   // rank2 for black = rank5
+     5,  5, 10, 25, 25, 10,  5,  5,   // rank3 for black = rank4
+     0,  0,  0, 20, 20,  0,  0,  0,   // rank4 for black = rank3
+     5, -5, -5,  0,  0, -5, -5,  5,   // rank5 for black = rank2
+     5, 10, 10,-20,-20, 10, 10,  5,   // rank6 for black = rank1
+     0,  0,  0,  0,  0,  0,  0,  0    // rank7 for black = rank0
+};
+
+// Black Knight PST
+inline constexpr int BlackKnightPST[64] = {
+    -50,-40,-30,-30,-30,-30,-40,-50,  // rank0 = white rank7
+    -40,-20,  0,  5,  5,  0,-20,-40,  // rank1 = white rank6
+    -30,  5, 10, 15, 15, 10,  5,-30,  // rank2 = white rank5
+    -30,  0, 15, 20, 20, 15,  0,-30,  // rank3 = white rank4
+    -30,  5, 15, 20, 20, 15,  5,-30,  // rank4 = white rank3
+    -30,  0, 10, 15, 15, 10,  0,-30,  // rank5 = white rank2
+    -40,-20,  0,  0,  0,  0,-20,-40,  // rank6 = white rank1
+    -50,-40,-30,-30,-30,-30,-40,-50   // rank7 = white rank0
+};
+
+// Black Bishop PST
+inline constexpr int BlackBishopPST[64] = {
+    -20,-10,-10,-10,-10,-10,-10,-20,  // rank0
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5, 10, 10,  5,  0,-10,
+    -10,  5,  5, 10, 10,  5,  5,-10,
+    -10,  0, 10, 10, 10, 10,  0,-10,
+    -10, 10, 10, 10, 10, 10, 10,-10,
+    -10,  5,  0,  0,  0,  0,  5,-10,
+    -20,-10,-10,-10,-10,-10,-10,-20   // rank7
+};
+
+// Black Rook PST
+inline constexpr int BlackRookPST[64] = {
+      0,  0,  5, 10, 10,  5,  0,  0,  // rank0 = white rank7
+      5, 10, 10, 10, 10, 10, 10,  5,  // rank1 = white rank6
+     -5,  0,  0,  0,  0,  0,  0, -5,  // rank2 = white rank5
+     -5,  0,  0,  0,  0,  0,  0, -5,  // rank3 = white rank4
+     -5,  0,  0,  0,  0,  0,  0, -5,  // rank4 = white rank3
+     -5,  0,  0,  0,  0,  0,  0, -5,  // rank5 = white rank2
+     -5,  0,  0,  0,  0,  0,  0, -5,  // rank6 = white rank1
+      0,  0,  5, 10, 10,  5,  0,  0   // rank7 = white rank0
+};
+
+// Black Queen PST
+inline constexpr int BlackQueenPST[64] = {
+    -20,-10,-10, -5, -5,-10,-10,-20,  // rank0 = white rank7
+    -10,  0,  0,  0,  0,  0,  5,-10,
+    -10,  0,  5,  5,  5,  5,  5,-10,
+     -5,  0,  5,  5,  5,  5,  0, -5,
+      0,  0,  5,  5,  5,  5,  0, -5,
+    -10,  0,  5,  5,  5,  5,  5,-10,
+    -10,  0,  0,  0,  0,  0,  5,-10,
+    -20,-10,-10, -5, -5,-10,-10,-20   // rank7 = white rank0
+};
+
+// Black King PST (middle game, for example)
+inline constexpr int BlackKingPST[64] = {
+     20, 30, 10,  0,  0, 10, 30, 20,  // rank0 = white rank7
+     20, 20,  0,  0,  0,  0, 20, 20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30   // rank7 = white rank0
+};
+
+// PSQT[piece][square]: material plus square bonus, signed by colour;
+// the row for e (no piece) is all zero
+struct PsqTable {
+    Score values[13][64] = {};
+
+    constexpr PsqTable() {
+        const int *const tables[12] = {
+            WhitePawnPST, WhiteRookPST, WhiteKnightPST, WhiteBishopPST, WhiteQueenPST, WhiteKingPST,
+            BlackPawnPST, BlackRookPST, BlackKnightPST, BlackBishopPST, BlackQueenPST, BlackKingPST
+        };
+        for (int pt = 0; pt < 12; ++pt) {
+            int sign = (pt < 6) ? 1 : -1;
+            for (int sq = 0; sq < 64; ++sq) {
+                int value = sign * (PieceValue[pt] + tables[pt][sq]);
+                values[pt][sq] = make_score(value, value);
+            }
+        }
+    }
+
+    constexpr const Score *operator[](int pt) const {
+        return values[pt];
+    }
+};
+
+inline constexpr PsqTable PSQT;
+
+#endif // PSQT_HPP
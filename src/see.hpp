@@ -0,0 +1,113 @@
+#ifndef SEE_HPP
+#define SEE_HPP
+
+#include <algorithm>
+
+#include "board.hpp"
+#include "attacks.hpp"
+#include "psqt.hpp"
+#include "utils.hpp"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Static exchange evaluation: the material the side to move wins (or, if
+// negative, loses) by playing `m` and then letting both sides keep
+// recapturing on the target square, always with their least valuable
+// attacker, each free to stop when going on would cost them.
+//
+// Attackers come from attackers_to() with an occupancy that loses each
+// piece as it captures, so a slider standing behind it (a rook behind a
+// rook, a bishop behind a pawn or queen) joins in: an x-ray.
+// Pins and checks are ignored, as usual; the king is worth so much that
+// it only ever takes last.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Piece worth for exchanges: the evaluation's material values, nothing for
+// an empty square, and for the king more than all the other pieces together
+inline constexpr int SEE_KING_VALUE = 20000;
+
+inline constexpr int see_value(PieceType pt) {
+    return pt == e ? 0 : (pt == K || pt == k) ? SEE_KING_VALUE : PieceValue[pt];
+}
+
+inline int see(const board &chess_board, const Move &m) {
+    if (m.is_castling()) {
+        return 0;
+    }
+
+    int from = m.src_square();
+    int to   = m.dst_square();
+    PieceType attacker = chess_board.chessboard[from];
+    Color side = (attacker < p) ? White : Black;
+
+    Bitboard occupied = chess_board.getOccupied() ^ (1ULL << from);
+    int gain[32];
+    int depth = 0;
+
+    gain[0] = see_value(m.is_en_passant() ? P : chess_board.chessboard[to]);
+    int attackerValue = see_value(attacker);
+    if (m.is_en_passant()) {
+        occupied ^= 1ULL << (side == White ? to - 8 : to + 8);
+    } else if (m.is_promotion()) {
+        // The pawn turns into something worth more, and that is what can be taken back
+        static constexpr PieceType Promoted[4] = {N, B, R, Q};
+        attackerValue = PieceValue[Promoted[m.flag() - PROMOTION_KNIGHT]];
+        gain[0] += attackerValue - PieceValue[P];
+    }
+
+    const Bitboard diagonal   = chess_board.bitboards[B] | chess_board.bitboards[b] |
+                                chess_board.bitboards[Q] | chess_board.bitboards[q];
+    const Bitboard orthogonal = chess_board.bitboards[R] | chess_board.bitboards[r] |
+                                chess_board.bitboards[Q] | chess_board.bitboards[q];
+    Bitboard attackers = chess_board.attackers_to(to, occupied) & occupied;
+
+    // Least valuable first: P N B R Q K
+    static constexpr PieceType Order[6] = {P, N, B, R, Q, K};
+
+    while (true) {
+        ++depth;
+        side = (side == White) ? Black : White;
+
+        // What the side now to recapture gains if it takes the last capturer
+        gain[depth] = attackerValue - gain[depth - 1];
+        if (std::max(-gain[depth - 1], gain[depth]) < 0 || depth == 31) {
+            break;   // one side already stops here whatever follows
+        }
+
+        Bitboard ours = attackers & chess_board.colorOccupancy[side];
+        if (!ours) {
+            break;
+        }
+
+        int offset = (side == White) ? 0 : 6;
+        PieceType next = e;
+        Bitboard fromBB = 0ULL;
+        for (PieceType pt : Order) {
+            Bitboard candidates = ours & chess_board.bitboards[pt + offset];
+            if (candidates) {
+                next = pt;
+                fromBB = candidates & (0ULL - candidates);   // one of them
+                break;
+            }
+        }
+
+        occupied  ^= fromBB;
+        attackerValue = see_value(next);
+
+        // Uncover the sliders behind the piece that just took
+        if (next == P || next == B || next == Q) {
+            attackers |= bishop_attacks(to, occupied) & diagonal;
+        }
+        if (next == R || next == Q) {
+            attackers |= rook_attacks(to, occupied) & orthogonal;
+        }
+        attackers &= occupied;
+    }
+
+    // Each side picks the better of stopping or going on, from the back
+    while (--depth) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    }
+    return gain[0];
+}
+
+#endif // SEE_HPP
@@ -0,0 +1,75 @@
+#ifndef TIMEMAN_HPP
+#define TIMEMAN_HPP
+
+#include <chrono>
+#include <algorithm>
+#include "utils.hpp"
+
+// What "go" asked for. -1 / 0 mean "not given".
+struct SearchLimits {
+    int depth     = -1;
+    int movetime  = -1;               // ms
+    int time[2]   = {-1, -1};         // wtime, btime (ms), indexed by Color
+    int inc[2]    = {0, 0};           // winc, binc (ms)
+    int movestogo = 0;
+    bool infinite = false;
+
+    // Whether the search of `us` is bounded by the clock. Only our own
+    // clock counts: "go wtime ..." with Black to move sets no limit for Black.
+    bool use_time(Color us) const {
+        return movetime >= 0 || time[us] >= 0;
+    }
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Turns the "go" limits into two deadlines for the side to move:
+//  - soft: don't start another iteration after this
+//  - hard: abort the iteration in progress (the search polls it every few
+//          thousand nodes) and play the best move of the last one finished
+// With movetime both are the given time. With a clock, a move gets an even
+// share of what is left over the remaining moves (movestogo, or a guess)
+// plus most of the increment, and may overrun that up to the hard limit.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct TimeManager {
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int MOVE_OVERHEAD = 30;      // ms kept back for I/O and GUI lag
+    static constexpr int DEFAULT_MOVES_TO_GO = 30;
+
+    Clock::time_point start = Clock::now();
+    long long soft_ms = -1;    // -1: no limit
+    long long hard_ms = -1;
+
+    void init(const SearchLimits &limits, Color us) {
+        start   = Clock::now();
+        soft_ms = hard_ms = -1;
+
+        if (limits.infinite) {
+            return;
+        }
+        if (limits.movetime >= 0) {
+            soft_ms = hard_ms = std::max(1, limits.movetime - MOVE_OVERHEAD);
+            return;
+        }
+        if (limits.time[us] < 0) {
+            return;
+        }
+
+        long long left = std::max(1, limits.time[us] - MOVE_OVERHEAD);
+        int mtg = limits.movestogo > 0 ? std::min(limits.movestogo, DEFAULT_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+
+        long long base = left / mtg + limits.inc[us] * 3 / 4;
+        hard_ms = std::max(1LL, std::min(base * 4, left * 3 / 4));
+        soft_ms = std::max(1LL, std::min(base, hard_ms));
+    }
+
+    long long elapsed() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    }
+
+    bool soft_expired() const { return soft_ms >= 0 && elapsed() >= soft_ms; }
+    bool hard_expired() const { return hard_ms >= 0 && elapsed() >= hard_ms; }
+};
+
+#endif // TIMEMAN_HPP
@@ -0,0 +1,169 @@
+#ifndef TT_HPP
+#define TT_HPP
+
+#include <atomic>
+#include <memory>
+#include "utils.hpp"
+#include "zobrist.hpp"
+
+// How a stored score relates to the true value of the position
+enum Bound : uint8_t {
+    BOUND_NONE  = 0,
+    BOUND_UPPER = 1,   // search failed low, true score <= score
+    BOUND_LOWER = 2,   // search failed high, true score >= score
+    BOUND_EXACT = 3
+};
+
+// A decoded table entry, as handed out by probe()
+struct TTEntry {
+    Move  move;
+    int   score;
+    int   depth;
+    Bound bound;
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Transposition table shared by every search thread.
+//
+// Each slot is two 64-bit words: the packed entry (`data`) and the position
+// key XOR-ed with it (`check`). Both are written and read without locks; if
+// two threads race on a slot and a reader sees one word from each writer,
+// check ^ data no longer equals the key and the probe simply misses.
+//
+// Slots are grouped four to a 64-byte bucket. A new entry replaces the slot
+// holding the same position, otherwise the one that is shallowest and
+// oldest. The age is the search generation, bumped by new_search(), so
+// entries left over from earlier moves of the game are evicted first.
+//
+// data layout:  bits  0-15 move | 16-23 depth | 24-25 bound | 26-31 age | 32-63 score
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct TranspositionTable {
+    static constexpr int BUCKET_SIZE = 4;
+    static constexpr int DEFAULT_MB  = 16;
+    static constexpr int MAX_MB      = 4096;
+
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_SIZE];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucket_count = 0;
+    uint8_t generation  = 0;   // 6 bits are stored per entry
+
+    TranspositionTable() { resize(DEFAULT_MB); }
+
+    // Reallocate to `mb` megabytes and clear. Not safe while a search runs.
+    void resize(size_t mb) {
+        bucket_count = std::max<size_t>(1, mb * 1024 * 1024 / sizeof(Bucket));
+        buckets.reset(new Bucket[bucket_count]);
+        clear();
+    }
+
+    void clear() {
+        for (size_t i = 0; i < bucket_count; ++i) {
+            for (Slot &s : buckets[i].slots) {
+                s.check.store(0, std::memory_order_relaxed);
+                s.data.store(0, std::memory_order_relaxed);
+            }
+        }
+        generation = 0;
+    }
+
+    // Called once per "go", ages everything already in the table
+    void new_search() { generation = (generation + 1) & 63; }
+
+    // Looks up `key`; fills `out` and returns true on a hit
+    bool probe(Key key, TTEntry &out) const {
+        const Bucket &bucket = buckets[index(key)];
+        for (const Slot &s : bucket.slots) {
+            uint64_t data  = s.data.load(std::memory_order_relaxed);
+            uint64_t check = s.check.load(std::memory_order_relaxed);
+            if ((check ^ data) == key && unpack_bound(data) != BOUND_NONE) {
+                out = unpack(data);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(Key key, int depth, int score, Bound bound, Move move) {
+        Bucket &bucket = buckets[index(key)];
+
+        Slot *replace = nullptr;
+        int worst = INT32_MAX;
+        for (Slot &s : bucket.slots) {
+            uint64_t data = s.data.load(std::memory_order_relaxed);
+            if ((s.check.load(std::memory_order_relaxed) ^ data) == key) {
+                // Same position: keep a deeper result from this search unless
+                // the new one is exact, and keep the old move if we have none
+                if (bound != BOUND_EXACT && unpack_age(data) == generation &&
+                    depth < int((data >> 16) & 0xFF) - 2) {
+                    return;
+                }
+                if (move.is_null()) {
+                    move.data = uint16_t(data & 0xFFFF);
+                }
+                replace = &s;
+                break;
+            }
+            // Shallow entries from old searches are the cheapest to lose
+            int age_gap = (generation - unpack_age(data)) & 63;
+            int worth = int((data >> 16) & 0xFF) - 8 * age_gap;
+            if (worth < worst) {
+                worst = worth;
+                replace = &s;
+            }
+        }
+
+        uint64_t data = uint64_t(move.data)
+                      | (uint64_t(std::min(depth, 255) & 0xFF) << 16)
+                      | (uint64_t(bound) << 24)
+                      | (uint64_t(generation) << 26)
+                      | (uint64_t(uint32_t(score)) << 32);
+        replace->data.store(data, std::memory_order_relaxed);
+        replace->check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    // Hint the CPU to start loading the bucket before it is needed
+    void prefetch(Key key) const {
+        __builtin_prefetch(&buckets[index(key)]);
+    }
+
+    // Maps the key uniformly onto [0, bucket_count) without needing a power of two
+    size_t index(Key key) const {
+        return size_t((unsigned __int128)key * bucket_count >> 64);
+    }
+
+    static Bound unpack_bound(uint64_t data) { return Bound((data >> 24) & 3); }
+    static uint8_t unpack_age(uint64_t data)  { return uint8_t((data >> 26) & 63); }
+
+    static TTEntry unpack(uint64_t data) {
+        TTEntry entry;
+        entry.move.data = uint16_t(data & 0xFFFF);
+        entry.depth     = int((data >> 16) & 0xFF);
+        entry.bound     = unpack_bound(data);
+        entry.score     = int32_t(uint32_t(data >> 32));
+        return entry;
+    }
+};
+
+// Mate scores count plies from the root, but the table may be hit from a node
+// at another ply. They are stored counted from the node itself instead.
+inline int score_to_tt(int score, int ply) {
+    return score >= MATE_BOUND ? score + ply : score <= -MATE_BOUND ? score - ply : score;
+}
+
+inline int score_from_tt(int score, int ply) {
+    return score >= MATE_BOUND ? score - ply : score <= -MATE_BOUND ? score + ply : score;
+}
+
+// The one table, shared by all searches in the process
+inline TranspositionTable TT;
+
+#endif // TT_HPP
@@ -4,18 +4,45 @@
 #include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 namespace UCI {
 
+// The search runs on its own thread so the loop can still read "stop",
+// "isready" and "quit". Set to ask the running search to finish now.
+static std::atomic<bool> stop_requested{false};
+static std::thread search_thread;
+
+// Lazy SMP search threads, set with "setoption name Threads"
+static int search_threads = 1;
+
+// Forward pruning margins, set with "setoption name FutilityMargin" etc.
+static PruningMargins pruning_margins;
+
+// Wait for the running search (if any) to print its bestmove
+static void wait_for_search() {
+    if (search_thread.joinable()) {
+        search_thread.join();
+    }
+}
+
+// Ask the running search to finish now, and wait for it
+static void stop_search() {
+    stop_requested = true;
+    wait_for_search();
+}
+
 // Apply a sequence of UCI moves like ["e2e4","b8c6", ...] to board b
 // using the engine's own Move struct + apply_move().
 // We also debug after each move.
 static void apply_move_list_uci(board& b, const std::vector<std::string>& moves) {
     for (const std::string& mvStr : moves) {
-        // Convert "e2e4" -> Move(src_bitboard, dst_bitboard, promotionChar)
+        // Convert "e2e4" -> packed Move(src, dst, flag)
         Move m = uci_to_move(mvStr, b);
 
-        if (m.src_pos == 0 && m.dst_pos == 0) {
+        if (m.is_null()) {
             std::cerr << "[UCI] WARNING: couldn't parse move '" << mvStr << "'\n";
             break;
         }
@@ -54,26 +81,61 @@ void run_uci_loop() {
             // Identify the engine
             std::cout << "id name " << ENGINE_NAME << " " << ENGINE_VERSION << std::endl;
             std::cout << "id author " << AUTHOR << std::endl;
+            std::cout << "option name Hash type spin default " << TranspositionTable::DEFAULT_MB
+                      << " min 1 max " << TranspositionTable::MAX_MB << std::endl;
+            std::cout << "option name Threads type spin default 1 min 1 max " << Evaluator::MAX_THREADS << std::endl;
+            std::cout << "option name FutilityMargin type spin default " << PruningMargins().futility
+                      << " min 0 max 1000" << std::endl;
+            std::cout << "option name ReverseFutilityMargin type spin default " << PruningMargins().reverse_futility
+                      << " min 0 max 1000" << std::endl;
+            std::cout << "option name RazorMargin type spin default " << PruningMargins().razor
+                      << " min 0 max 1000" << std::endl;
             std::cout << "uciok" << std::endl;
 
         } else if (command == "isready") {
-            // Respond that engine is ready
+            // Respond that engine is ready (also while searching)
             std::cout << "readyok" << std::endl;
 
         } else if (command == "ucinewgame") {
-            // Reset board for new game
+            // Reset board for new game; nothing learned about the old one applies.
+            // A search still running belongs to the old game: stop it first.
+            stop_search();
             chess_board = board();
+            TT.clear();
+            Heuristics.clear();
+
+        } else if (command == "setoption") {
+            // Change an engine option; not while a search is using it
+            stop_search();
+            handle_setoption(line);
 
         } else if (command == "position") {
             // Set up board position
             handle_position(chess_board, line);
 
+        } else if (command == "perft") {
+            // Count move-tree leaves: "perft <depth> [divide] [threads <n>] [hash <mb>]"
+            stop_search();
+            handle_perft(chess_board, line);
+
         } else if (command == "go") {
-            // Calculate best move
-            handle_go(chess_board, line);
+            // Calculate best move in the background, on a copy of the board
+            // so a following "position" cannot change it mid-search. A search
+            // still running is stopped first (it prints its bestmove), so a
+            // new "go" never queues behind an infinite or deep search.
+            stop_search();
+            stop_requested = false;
+            search_thread = std::thread([position = chess_board, line]() mutable {
+                handle_go(position, line);
+            });
+
+        } else if (command == "stop") {
+            // Finish the search now; it prints its bestmove
+            stop_search();
 
         } else if (command == "quit") {
             // Exit
+            stop_search();
             break;
 
         } else if (command == "d") {
@@ -84,6 +146,79 @@ void run_uci_loop() {
             // Unknown command - ignore (UCI spec says to ignore)
         }
     }
+
+    // Input closed without "quit"
+    stop_search();
+}
+
+/**
+ * Handle "perft <depth> [divide] [threads <n>] [hash <mb>]",
+ * also reached through "go perft <depth>" (which always divides)
+ */
+void handle_perft(board& b, const std::string& command) {
+    std::istringstream iss(command);
+    std::string token;
+
+    int depth = 1;
+    bool divide = false;
+    int threads = default_perft_threads();
+    size_t hashMB = 0;
+
+    iss >> token; // "perft" or "go"
+    if (token == "go") {
+        iss >> token; // "perft"
+        divide = true;
+    }
+    iss >> depth;
+
+    while (iss >> token) {
+        if (token == "divide") {
+            divide = true;
+        } else if (token == "threads") {
+            iss >> threads;
+        } else if (token == "hash") {
+            iss >> hashMB;
+        }
+    }
+
+    run_perft(b, depth, divide, threads, hashMB);
+}
+
+/**
+ * Handle "setoption name <id> [value <x>]"
+ */
+void handle_setoption(const std::string& command) {
+    std::istringstream iss(command);
+    std::string token, name, value;
+
+    iss >> token; // "setoption"
+    iss >> token; // "name"
+
+    // Option names may contain spaces, so read up to "value"
+    while (iss >> token && token != "value") {
+        if (!name.empty()) name += " ";
+        name += token;
+    }
+    iss >> value;
+
+    if (name == "Hash") {
+        int mb = std::atoi(value.c_str());
+        mb = std::max(1, std::min(mb, TranspositionTable::MAX_MB));
+        TT.resize(mb);
+        std::cerr << "[UCI] Hash set to " << mb << " MB\n";
+    } else if (name == "Threads") {
+        search_threads = std::max(1, std::min(std::atoi(value.c_str()), Evaluator::MAX_THREADS));
+        std::cerr << "[UCI] Threads set to " << search_threads << "\n";
+    } else if (name == "FutilityMargin" || name == "ReverseFutilityMargin" || name == "RazorMargin") {
+        int margin = std::max(0, std::min(std::atoi(value.c_str()), 1000));
+        int &target = (name == "FutilityMargin")        ? pruning_margins.futility
+                    : (name == "ReverseFutilityMargin") ? pruning_margins.reverse_futility
+                                                        : pruning_margins.razor;
+        target = margin;
+        std::cerr << "[UCI] " << name << " set to " << margin << "\n";
+    } else {
+        std::cerr << "[UCI] unknown option '" << name << "'\n";
+    }
 }
 
 /**
@@ -99,8 +234,10 @@ void parse_fen(board& chess_board, const std::string& fen) {
     
     iss >> pieces >> turn >> castling >> enpassant >> halfmove >> fullmove;
 
-    // Reset board
+    // Reset board to an empty one (the constructor sets up the start position)
     chess_board = board();
+    chess_board.bitboards.fill(0ULL);
+    chess_board.chessboard.fill(e);
 
     // Parse piece placement (ranks 8 to 1)
     int square_idx = 56; // Start at a8 (rank 8, file a)
@@ -138,15 +275,30 @@ void parse_fen(board& chess_board, const std::string& fen) {
         }
     }
 
+    chess_board.refresh_occupancy();
+
     // Set turn
     chess_board.boardTurn = (turn == "w") ? White : Black;
 
-    // Parse castling rights - map to your existing structure
-    // Note: Your board uses King_moved, Rook_KingSide_moved, etc.
-    // For now, we'll just track if castling is generally possible
-    // TODO: Properly map UCI castling rights to your board's castling flags
+    // Parse castling rights ("KQkq", any subset, or "-")
+    chess_board.castling_rights = 0;
+    for (char c : castling) {
+        switch (c) {
+            case 'K': chess_board.castling_rights |= WHITE_OO;  break;
+            case 'Q': chess_board.castling_rights |= WHITE_OOO; break;
+            case 'k': chess_board.castling_rights |= BLACK_OO;  break;
+            case 'q': chess_board.castling_rights |= BLACK_OOO; break;
+            default: break;
+        }
+    }
+
+    // Parse en passant target square ("e3" or "-")
+    Bitboard ep = algebraic_to_square(enpassant);
+    chess_board.en_passant_square = ep ? __builtin_ctzll(ep) : -1;
 
-    // TODO: Handle en passant square if needed
+    chess_board.key = chess_board.compute_key();
+    chess_board.pawnKey = chess_board.compute_pawn_key();
+    chess_board.psq = chess_board.compute_psq();
 }
 
 /**
@@ -297,32 +449,62 @@ void handle_go(board& b, const std::string& command) {
     
     iss >> token; // this was "go"
     
-    int depth = 5;
-    int movetime = -1; // ms, optional
+    SearchLimits limits;
 
-    // Parse params like "depth 6", "movetime 500"
+    // Parse params like "depth 6", "movetime 500", "wtime 60000 btime 60000 winc 1000"
     while (iss >> token) {
         if (token == "depth") {
-            iss >> depth;
+            iss >> limits.depth;
         } else if (token == "movetime") {
-            iss >> movetime;
+            iss >> limits.movetime;
+        } else if (token == "wtime") {
+            iss >> limits.time[White];
+        } else if (token == "btime") {
+            iss >> limits.time[Black];
+        } else if (token == "winc") {
+            iss >> limits.inc[White];
+        } else if (token == "binc") {
+            iss >> limits.inc[Black];
+        } else if (token == "movestogo") {
+            iss >> limits.movestogo;
         } else if (token == "infinite") {
-            depth = 10; // arbitrary fallback
+            limits.infinite = true;
+        } else if (token == "perft") {
+            // "go perft N" counts nodes instead of searching
+            handle_perft(b, command);
+            return;
         }
     }
 
+    // Deepen until the clock or "stop" says otherwise; with neither, to the given depth
+    int depth = limits.depth;
+    if (depth <= 0) {
+        depth = (limits.infinite || limits.use_time(b.boardTurn)) ? Evaluator::MAX_SEARCH_DEPTH : 5;
+    }
+
     std::cerr << "[UCI] handle_go: side to move is "
               << (b.boardTurn == White ? "White" : "Black")
               << ", depth=" << depth
-              << (movetime >= 0 ? (", movetime=" + std::to_string(movetime)) : "")
+              << (limits.movetime >= 0 ? (", movetime=" + std::to_string(limits.movetime)) : "")
               << "\n";
 
     Evaluator evaluator;
     evaluator.max_depth = depth;
+    evaluator.limits = limits;
+    evaluator.print_info = true;
+    evaluator.stop_signal = &stop_requested;
+    evaluator.threads = search_threads;
+    evaluator.margins = pruning_margins;
 
     Move bestMove = evaluator.get_best_move(b);
 
-    if (bestMove.src_pos == 0 && bestMove.dst_pos == 0) {
+    // "go infinite" must not answer before it is told to stop, even if the
+    // search has nothing left to do
+    while (limits.infinite && !stop_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (bestMove.is_null()) {
         // evaluator couldn't find anything
         std::cerr << "[UCI] get_best_move() returned NO MOVE. Falling back.\n";
 
@@ -332,15 +514,16 @@ void handle_go(board& b, const std::string& command) {
         //
         // This prevents the Python bridge from hanging, and lets the
         // frontend stop gracefully.
-        std::cout << "bestmove 0000" << std::endl;
+        std::cout << "bestmove 0000\n" << std::flush;
         return;
     }
 
     std::string uci_move = move_to_uci(bestMove, b);
     std::cerr << "[UCI] bestmove (from search) = " << uci_move << "\n";
 
-    // Always respond with bestmove line, guaranteed
-    std::cout << "bestmove " << uci_move << std::endl;
+    // Always respond with bestmove line, guaranteed. Written in one piece,
+    // since the UCI thread may be printing "readyok" at the same time.
+    std::cout << ("bestmove " + uci_move + "\n") << std::flush;
 }
 
 
@@ -348,13 +531,13 @@ void handle_go(board& b, const std::string& command) {
  * Convert internal Move to UCI format
  */
 std::string move_to_uci(const Move& move, const board& b) {
-    std::string from = square_to_algebraic(move.src_pos);
-    std::string to = square_to_algebraic(move.dst_pos);
+    std::string from = square_to_algebraic(move.src_pos());
+    std::string to = square_to_algebraic(move.dst_pos());
     
     // Handle promotion
     std::string promotion_str = "";
-    if (move.promotion != '\0') {
-        promotion_str = std::string(1, std::tolower(move.promotion));
+    if (move.is_promotion()) {
+        promotion_str = std::string(1, move.promotion());
     }
     
     return from + to + promotion_str;
@@ -365,7 +548,7 @@ std::string move_to_uci(const Move& move, const board& b) {
  */
 Move uci_to_move(const std::string& uci_move, const board& b) {
     if (uci_move.length() < 4) {
-        return Move(0, 0, '\0'); // Invalid move
+        return Move(); // Invalid move
     }
 
     std::string from_str = uci_move.substr(0, 2);
@@ -373,13 +556,26 @@ Move uci_to_move(const std::string& uci_move, const board& b) {
     
     Bitboard from = algebraic_to_square(from_str);
     Bitboard to = algebraic_to_square(to_str);
-    
-    char promotion = '\0';
+    if (from == 0 || to == 0) {
+        return Move(); // Invalid squares
+    }
+
+    int src = __builtin_ctzll(from);
+    int dst = __builtin_ctzll(to);
+
+    // UCI only spells out promotions; castling and en passant are
+    // recognised from the piece that moves on the current board
+    MoveFlag flag = NORMAL;
+    PieceType piece = b.chessboard[src];
     if (uci_move.length() >= 5) {
-        promotion = std::toupper(uci_move[4]);
+        flag = promotion_flag(uci_move[4]);
+    } else if ((piece == K || piece == k) && std::abs(dst - src) == 2) {
+        flag = CASTLING;
+    } else if ((piece == P || piece == p) && dst == b.en_passant_square) {
+        flag = EN_PASSANT;
     }
     
-    return Move(from, to, promotion);
+    return Move(src, dst, flag);
 }
 
 /**
@@ -6,6 +6,7 @@
 #include <iostream>
 #include "board.hpp"
 #include "evaluate.hpp"
+#include "perft.hpp"
 
 /**
  * UCI (Universal Chess Interface) Protocol Handler
@@ -16,8 +17,11 @@
  * Key UCI Commands:
  * - uci: Identify the engine
  * - isready: Check if engine is ready
+ * - setoption: Change an engine option (Hash, Threads, pruning margins)
  * - position: Set up the board position
- * - go: Start calculating the best move
+ * - go: Start calculating the best move in the background (or "go perft N")
+ * - stop: End the search and report its best move
+ * - perft: Count legal move tree leaves (non-standard, for testing)
  * - quit: Exit the engine
  */
 
@@ -57,6 +61,23 @@ namespace UCI {
      */
     void handle_go(board& b, const std::string& command);
 
+    /**
+     * Parse "setoption" UCI command
+     * Examples:
+     *   setoption name Hash value 64
+     *   setoption name Threads value 4
+     *   setoption name FutilityMargin value 120
+     */
+    void handle_setoption(const std::string& command);
+
+    /**
+     * Parse "perft" UCI command (also "go perft N")
+     * Examples:
+     *   perft 5
+     *   perft 6 divide threads 4 hash 64
+     */
+    void handle_perft(board& b, const std::string& command);
+
     /**
      * Convert internal Move to UCI format (e.g., "e2e4", "e7e8q" for promotion)
      */
@@ -14,6 +14,7 @@
 #include <cstdint>       // For fixed-width integer types (e.g., uint64_t)
 #include <bitset>        // For low-level bit manipulations
 #include <cassert>       // For debugging with assertions
+#include <memory>        // For std::unique_ptr
 
 
 typedef uint64_t Bitboard;
@@ -39,28 +40,47 @@ constexpr Bitboard RANK_8 = 0b00000000000000000000000000000000000000000000000000
 constexpr Bitboard RANK_2 = 0x000000000000FF00ULL;
 constexpr Bitboard RANK_7 = 0x00FF000000000000ULL;
 
-// Constants for checking the presence of rooks and kings at these positions to determine if they moved
-constexpr Bitboard WhiteRookQueenSideSquare = 0b0000000000000000000000000000000000000000000000000000000010000000ULL;
-constexpr Bitboard WhiteRookKingSideSquare = 0b0000000000000000000000000000000000000000000000000000000000000001ULL;
-constexpr Bitboard BlackRookQueenSideSquare = 0b1000000000000000000000000000000000000000000000000000000000000000ULL;
-constexpr Bitboard BlackRookKingSideSquare = 0b0000000100000000000000000000000000000000000000000000000000000000ULL;
-constexpr Bitboard White_King_square = 0b0000000000000000000000000000000000000000000000000000000000001000ULL;
-constexpr Bitboard Black_King_square = 0b0000100000000000000000000000000000000000000000000000000000000000ULL;
-
-// Constants to determine if the way is clear for castling
-constexpr Bitboard WhiteRookQueenSideAlley = 0b0000000000000000000000000000000000000000000000000000000001110000ULL;
-constexpr Bitboard WhiteRookKingSideAlley = 0b0000000000000000000000000000000000000000000000000000000000000110ULL;
-constexpr Bitboard BlackRookQueenSideAlley = 0b0111000000000000000000000000000000000000000000000000000000000000ULL;
-constexpr Bitboard BlackRookKingSideAlley = 0b0000011000000000000000000000000000000000000000000000000000000000ULL;
-
-// 
+// Home squares of the kings and rooks (a1 = bit 0, h8 = bit 63)
+constexpr Bitboard WhiteRookQueenSideSquare = (1ULL << 0);   // a1
+constexpr Bitboard WhiteRookKingSideSquare  = (1ULL << 7);   // h1
+constexpr Bitboard BlackRookQueenSideSquare = (1ULL << 56);  // a8
+constexpr Bitboard BlackRookKingSideSquare  = (1ULL << 63);  // h8
+constexpr Bitboard White_King_square = (1ULL << 4);          // e1
+constexpr Bitboard Black_King_square = (1ULL << 60);         // e8
+
+// Squares that must be empty between king and rook for castling
+constexpr Bitboard WhiteRookQueenSideAlley = (1ULL << 1) | (1ULL << 2) | (1ULL << 3);    // b1,c1,d1
+constexpr Bitboard WhiteRookKingSideAlley  = (1ULL << 5) | (1ULL << 6);                  // f1,g1
+constexpr Bitboard BlackRookQueenSideAlley = (1ULL << 57) | (1ULL << 58) | (1ULL << 59); // b8,c8,d8
+constexpr Bitboard BlackRookKingSideAlley  = (1ULL << 61) | (1ULL << 62);                // f8,g8
+
+// Castling rights, one bit per side and wing (as in the FEN "KQkq" field)
+enum CastlingRight {
+    WHITE_OO     = 1,   // K
+    WHITE_OOO    = 2,   // Q
+    BLACK_OO     = 4,   // k
+    BLACK_OOO    = 8,   // q
+    ALL_CASTLING = 15
+};
 
+// Rights that survive a move touching each square: rights &= mask[src] & mask[dst].
+// Moving the king or a rook off its home square, or capturing on a rook's
+// home square, clears the matching rights.
+constexpr std::array<int, 64> make_castling_rights_mask() {
+    std::array<int, 64> mask{};
+    for (int sq = 0; sq < 64; ++sq) mask[sq] = ALL_CASTLING;
+    mask[0]  &= ~WHITE_OOO;  mask[7]  &= ~WHITE_OO;  mask[4]  &= ~(WHITE_OO | WHITE_OOO);
+    mask[56] &= ~BLACK_OOO;  mask[63] &= ~BLACK_OO;  mask[60] &= ~(BLACK_OO | BLACK_OOO);
+    return mask;
+}
+inline constexpr std::array<int, 64> CastlingRightsMask = make_castling_rights_mask();
 
-// Used in moves.hpp to compute moves
+// Used in moves.hpp to compute moves, see generate<MoveType>()
 enum MoveType { 
-    LEGAL, 
-    PSEUDO_LEGAL, 
-    EVASIONS 
+    LEGAL,          // every legal move
+    EVASIONS,       // legal replies to check; only valid when in check
+    CAPTURES,       // legal captures, en passant and promotions
+    QUIETS          // the other legal moves, castling included
 };
 
 // Uppercase: white pieces // Lowercase: black pieces // e: empty
@@ -89,27 +109,112 @@ enum Color {
     Empty
 };
 
-// Structure to represent a move
+// Special move kinds, stored in the top 4 bits of a Move.
+// Promotions have bit 3 set and the piece in the low two bits.
+enum MoveFlag : uint16_t {
+    NORMAL           = 0,
+    CASTLING         = 1,
+    EN_PASSANT       = 2,
+    PROMOTION_KNIGHT = 8,
+    PROMOTION_BISHOP = 9,
+    PROMOTION_ROOK   = 10,
+    PROMOTION_QUEEN  = 11
+};
+
+// Structure to represent a move, packed into 16 bits:
+//   bits  0-5   source square (0-63)
+//   bits  6-11  destination square (0-63)
+//   bits 12-15  MoveFlag
+// The all-zero value (a1a1) doubles as "no move".
 struct Move {
-    Bitboard src_pos;    // Source square (0-63)
-    Bitboard dst_pos;    // Destination square (0-63)
-
-    char promotion;    // 'Q', 'R', 'B', 'N' (optional, for pawn promotion)
-    bool is_castling;  // True if the move is castling
-    bool is_en_passant; // True if the move is en passant capture
-
-    Move() 
-        : src_pos(0ULL), dst_pos(0ULL), promotion('\0'), 
-          is_castling(false), is_en_passant(false) {}
-
-    // **Parameterized Constructor**
-    Move(Bitboard src, Bitboard dst, char prom = '\0', 
-         bool castling = false, bool en_passant = false)
-        : src_pos(src), dst_pos(dst), promotion(prom), 
-          is_castling(castling), is_en_passant(en_passant) {}
+    uint16_t data;
+
+    // Trivial so that MoveList storage costs nothing to create;
+    // use Move() or Move{} for an all-zero "no move".
+    Move() = default;
+
+    constexpr Move(int src, int dst, MoveFlag flag = NORMAL)
+        : data(uint16_t(src | (dst << 6) | (flag << 12))) {}
+
+    int src_square() const     { return data & 0x3F; }
+    int dst_square() const     { return (data >> 6) & 0x3F; }
+    MoveFlag flag() const      { return MoveFlag(data >> 12); }
+
+    bool is_null() const       { return data == 0; }
+    bool is_castling() const   { return flag() == CASTLING; }
+    bool is_en_passant() const { return flag() == EN_PASSANT; }
+    bool is_promotion() const  { return (data >> 12) & 8; }
+
+    // 'q', 'r', 'b', 'n' for promotions, '\0' otherwise
+    char promotion() const {
+        static const char pieces[4] = {'n', 'b', 'r', 'q'};
+        return is_promotion() ? pieces[(data >> 12) & 3] : '\0';
+    }
+
+    // One-hot adapters for the UCI and file layers, which speak bitboards
+    Bitboard src_pos() const   { return 1ULL << src_square(); }
+    Bitboard dst_pos() const   { return 1ULL << dst_square(); }
+
+    bool operator==(const Move& other) const { return data == other.data; }
+    bool operator!=(const Move& other) const { return data != other.data; }
+};
+
+// Map a promotion letter from UCI / history files ('q', 'R', ...) to its flag.
+// 'k' is accepted for a knight, as older history files used it.
+inline MoveFlag promotion_flag(char piece) {
+    switch (piece) {
+        case 'q': case 'Q': return PROMOTION_QUEEN;
+        case 'r': case 'R': return PROMOTION_ROOK;
+        case 'b': case 'B': return PROMOTION_BISHOP;
+        case 'n': case 'N':
+        case 'k': case 'K': return PROMOTION_KNIGHT;
+        default:            return NORMAL;
+    }
+}
+
+
+// Upper bound on the number of moves in any legal chess position (218 is the known maximum)
+constexpr int MAX_MOVES = 256;
+
+// Fixed-capacity list of moves stored inline, so move generation never
+// touches the heap. Offers the subset of the std::vector API the engine uses.
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int count = 0;
+
+    void push_back(const Move& m) { moves[count++] = m; }
+
+    template <typename... Args>
+    void emplace_back(Args... args) { moves[count++] = Move(args...); }
+
+    void clear()                  { count = 0; }
+    bool empty() const            { return count == 0; }
+    size_t size() const           { return count; }
+
+    Move& operator[](size_t i)             { return moves[i]; }
+    const Move& operator[](size_t i) const { return moves[i]; }
+
+    Move* begin()             { return moves; }
+    Move* end()               { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const   { return moves + count; }
 };
 
 
+// Deepest search line the engine keeps per-ply state for (undo records, etc.)
+constexpr int MAX_PLY = 256;
+
+// Score for delivering mate at the root. A mate found n plies into the search
+// scores MATE_SCORE - n, so shorter mates score higher; anything beyond
+// MATE_BOUND is a mate score.
+constexpr int MATE_SCORE = 9999999;
+constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+// Bigger than any score a search can return; the initial window is
+// (-INFINITE_SCORE, INFINITE_SCORE). Safe to negate, unlike INT_MIN.
+constexpr int INFINITE_SCORE = MATE_SCORE + 1;
+
+
 // Global or external variable to track the number of moves
 inline static int num_of_moves = 0;
 
@@ -163,11 +268,11 @@ inline bool isBlackPiece(PieceType pt) {
     return (pt == p || pt == r || pt == n || pt == b || pt == q || pt == k);
 }
 
-// Convert a Move to e.g. "e2e4"
+// Convert a Move to e.g. "e2e4" or "e7e8q"
 inline std::string moveToAlgebraic(const Move& move) {
-    // Identify source and destination squares from bitboard
-    int src = __builtin_ctzll(move.src_pos); 
-    int dst = __builtin_ctzll(move.dst_pos);
+    // Identify source and destination squares from the packed move
+    int src = move.src_square();
+    int dst = move.dst_square();
     
     // Extract file/rank as 0..7
     int src_file = src % 8;
@@ -178,12 +283,14 @@ inline std::string moveToAlgebraic(const Move& move) {
     // Build a 4-character string
     //   file = 'a'..'h'
     //   rank = '1'..'8'
-    char notation[5];
+    //   plus the promotion letter, if any (e.g. "e7e8q")
+    char notation[6];
     notation[0] = 'a' + src_file;        // e.g. 'e'
     notation[1] = '1' + src_rank;       // e.g. '2'
     notation[2] = 'a' + dst_file;       // e.g. 'e'
     notation[3] = '1' + dst_rank;       // e.g. '4'
-    notation[4] = '\0';
+    notation[4] = move.promotion();
+    notation[5] = '\0';
 
     return std::string(notation);
 }
@@ -205,5 +312,26 @@ inline void writeMoveToFile(const char* filename, const Move& move) {
     std::cout << "File reset and move written: " << moveStr << std::endl;
 }
 
+// One T per search thread, by thread id, kept from one search to the next.
+// Grown (never shrunk) by the main thread before a search starts its
+// helpers, so the threads never see it change under them.
+template <typename T>
+struct PerThread {
+    std::vector<std::unique_ptr<T>> threads;
+
+    void ensure(int count) {
+        while (int(threads.size()) < count) {
+            threads.emplace_back(new T());
+        }
+    }
 
+    T &operator[](int id) {
+        return *threads[id];
+    }
 
+    void clear() {
+        for (auto &t : threads) {
+            t->clear();
+        }
+    }
+};
@@ -0,0 +1,55 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <array>
+#include "utils.hpp"
+
+// 64-bit position key. Two positions with the same pieces, side to move,
+// castling rights and en passant file get the same key.
+typedef uint64_t Key;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Zobrist random numbers, one per (piece, square), per castling-rights
+// mask, per en passant file, plus one for black to move. A position's key is
+// the XOR of the numbers for everything in it, so a move updates the key by
+// XOR-ing out what changed and XOR-ing in the new state.
+// The numbers come from a fixed-seed splitmix64 run at compile time, so keys
+// are the same in every build.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct ZobristKeys {
+    Key pieceSquare[12][64];
+    Key castling[16];        // indexed by the CastlingRight bits
+    Key enPassantFile[8];
+    Key blackToMove;
+};
+
+constexpr Key splitmix64(uint64_t &state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys make_zobrist_keys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x41736877617468ULL;   // "Ashwath"
+    for (int pt = 0; pt < 12; ++pt) {
+        for (int sq = 0; sq < 64; ++sq) {
+            keys.pieceSquare[pt][sq] = splitmix64(state);
+        }
+    }
+    // No rights at all hashes to nothing, so a bare board keys to 0
+    for (int cr = 1; cr < 16; ++cr) {
+        keys.castling[cr] = splitmix64(state);
+    }
+    for (int file = 0; file < 8; ++file) {
+        keys.enPassantFile[file] = splitmix64(state);
+    }
+    keys.blackToMove = splitmix64(state);
+    return keys;
+}
+
+inline constexpr ZobristKeys Zobrist = make_zobrist_keys();
+
+#endif // ZOBRIST_HPP